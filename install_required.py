@@ -85,6 +85,7 @@ if __name__ == '__main__':
 
     requirements = {
         'libv4l-dev' : apt_get,
+        'libjpeg-turbo8-dev' : apt_get,
         'libopencv-dev' : apt_get,
         # These live now in modules/stream:
 #        'libx264-dev' : apt_get,
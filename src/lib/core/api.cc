@@ -29,6 +29,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <cstdlib>
+
 #include "api.hh"
 #include "module_wrapper.hh"
 
@@ -47,13 +49,27 @@ tv::Api::Api(void) noexcept(noexcept(CameraControl()) and
         if (not environment_->set_user_prefix(USR_PREFIX)) {
             throw ConstructionException("Environment", USR_PREFIX);
         }
+        _load_thread_placements();
 
         // dynamic construction because not noexcept
         modules_ = new Modules(&Api::module_exec, this);
+        modules_->interrupt_timeout(
+            std::chrono::milliseconds(EXECUTOR_WAIT_LIMIT_MS));
 
         // dynamic construction because not noexcept
         module_loader_ = new ModuleLoader(*environment_);
 
+        // dynamic construction because not noexcept
+        pipeline_ = new FramePipeline(
+            [this](Image& frame) { return _capture_frame(frame); });
+
+        // one worker less than cores, the mainloop participates
+        auto const cores = std::thread::hardware_concurrency();
+        worker_pool_ = new WorkerPool(cores > 1 ? cores - 1 : 0);
+
+        // dynamic construction because not noexcept
+        callback_dispatcher_ = new CallbackDispatcher;
+
         active_ = true;
         executor_ = std::thread(&Api::execute, this);
 
@@ -85,6 +101,15 @@ tv::Api::~Api(void) {
     if (modules_) {
         delete modules_;
     }
+    if (worker_pool_) {
+        delete worker_pool_;
+    }
+    if (pipeline_) {
+        delete pipeline_;
+    }
+    if (callback_dispatcher_) {
+        delete callback_dispatcher_;
+    }
 }
 
 bool tv::Api::valid(void) const { return api_valid_; }
@@ -140,6 +165,7 @@ int16_t tv::Api::stop(void) {
 
         // Notify the threaded execution-context to stop and wait for it
         active_ = false;
+        _notify_work();
         executor_.join();
     }
 
@@ -155,12 +181,16 @@ int16_t tv::Api::stop(void) {
 int16_t tv::Api::quit(void) {
     Log("Api::quit");
 
+    // ... let modules being loaded arrive, ...
+    _wait_for_loads();
+
     // ... release the camera and join the execution thread
     (void)stop();
 
     // ... remove all modules from the shared context ...
     if (valid()) {
         remove_all_modules();
+        (void)modules_->reclaim();  // nothing executes them anymore
     }
 
     // \todo assert that everything has been stopped.
@@ -169,35 +199,158 @@ int16_t tv::Api::quit(void) {
 
 // Execute active module. This is the ONLY place where modules are executed.
 void tv::Api::module_exec(int16_t id, ModuleWrapper& module) {
+    if (_module_run(id, module, *frame_conversions_)) {
+        _module_finish(module);
+    }
+}
+
+bool tv::Api::_module_run(int16_t id, ModuleWrapper& module,
+                          FrameConversions& conversions) {
     // Log("API", "Executing module ", id);
 
     if (not module.enabled()) {  // skip paused modules
-        return;
+        return false;
     }
 
-    if (module.expected_format() !=
-        ColorSpace::NONE) {  // retrieve the frame in the requested format
-                             // and execute the module
+    if (module.expected_format() != ColorSpace::NONE and
+        module.scheduled()) {  // retrieve the frame in the requested format
+                               // and execute the module
 
-        conversions_.get_frame(image_, module.expected_format());
+        Image image;  // flat, per call since this might run concurrently
+        conversions.get_frame(image, module.expected_format());
         // ignoring result, doing callbacks (maybe, see default_callback_)
         try {
-            module.execute(image_);
+            auto& time = TimeSource::instance();
+            auto const start = time.now();
+            module.execute(image);
+
+            auto const budget = capture_interval_.load();
+            if (budget) {
+                module.account_execution((time.now() - start).count() >
+                                         budget);
+            }
         } catch (...) {
             LogError("API", "Module ", module.name(), " (", id, ") crashed: ");
-            module.tag(ModuleWrapper::Tag::Removable);
+            _module_removable(module);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool tv::Api::_module_run_async(ModuleWrapper& module, Module& instance,
+                                FrameConversions& conversions,
+                                Result& result) {
+    Image image;
+    if (module.expected_format() != ColorSpace::NONE) {
+        conversions.get_frame(image, module.expected_format());
+    }
+
+    try {
+        return module.execute_instance(instance, image, result);
+    } catch (...) {
+        LogError("API", "Module ", module.name(), " (", module.id(),
+                 ") crashed: ");
+        _module_removable(module);
+        return false;
+    }
+}
+
+void tv::Api::_exec_async_lanes(FramePipeline::Frame const& frame) {
+    AsyncLane::SharedFrame shared;
+
+    modules_->exec_all([&](int16_t id, ModuleWrapper& module) {
+        if (not module.enabled() or not module.async()) {
             return;
         }
+
+        auto const due = module.scheduled();
+        module.schedule(false);  // not in the mainloop
+
+        auto& lane = async_lanes_[id];
+        if (not lane) {
+            lane.reset(new AsyncLane(
+                module, module.parallel(),
+                [this](ModuleWrapper& module, Module& instance,
+                       FrameConversions& conversions, Result& result) {
+                    return _module_run_async(module, instance, conversions,
+                                             result);
+                }));
+        }
+
+        // one copy of the frame for all lanes waiting
+        if (due and lane->idle()) {
+            module.executing(frame.image().header.timestamp);
+            if (not shared) {
+                shared = _share_frame(frame);
+            }
+            lane->offer(shared);
+        }
+    });
+}
+
+tv::AsyncLane::SharedFrame tv::Api::_share_frame(
+    FramePipeline::Frame const& frame) {
+
+    // reuse a frame no lane is holding anymore
+    auto it = std::find_if(shared_frames_.begin(), shared_frames_.end(),
+                           [](AsyncLane::SharedFrame const& shared) {
+        return shared.use_count() == 1;
+    });
+
+    if (it == shared_frames_.end()) {
+        shared_frames_.emplace_back(new FramePipeline::Frame);
+        it = --shared_frames_.end();
+    }
+
+    auto& image = (*it)->image;
+    auto const& source = frame.image();
+    if (image().header != source.header) {
+        image.allocate(source.header, false);
+    }
+    image.copy_data(source.data, source.header.bytesize);
+    image.image().header.timestamp = source.header.timestamp;
+
+    (*it)->conversions.prepare(image(), {});
+    return *it;
+}
+
+void tv::Api::_stop_async_lanes(bool all) {
+    for (auto it = async_lanes_.begin(); it != async_lanes_.end();) {
+        auto module = (*modules_)[it->first];
+
+        if (all or not module or not module->enabled() or
+            not module->async() or
+            it->second->workers() != module->parallel() or
+            (module->tags() & ModuleWrapper::Tag::Removable)) {
+            it->second->stop();
+            it = async_lanes_.erase(it);
+        } else {
+            ++it;
+        }
     }
+}
 
+void tv::Api::_module_finish(ModuleWrapper& module) {
     auto& output = module.modified_image();
     if (output.header.format != ColorSpace::INVALID) {
-        conversions_.set_frame(output);
+        frame_conversions_->set_frame(output);
     }
 
-    auto& tags = module.tags();
+    _module_handle_tags(module);
+}
+
+void tv::Api::_module_removable(ModuleWrapper& module) {
+    // counted after tagging, so the mainloop can't miss the tag
+    module.tag(ModuleWrapper::Tag::Removable);
+    removals_pending_++;
+}
+
+void tv::Api::_module_handle_tags(ModuleWrapper& module) {
+    auto const tags = module.tags();
     if (tags & ModuleWrapper::Tag::ExecAndRemove) {
-        module.tag(ModuleWrapper::Tag::Removable);
+        _module_removable(module);
         camera_control_.release();
 
     } else if (tags & ModuleWrapper::Tag::ExecAndDisable) {
@@ -207,55 +360,133 @@ void tv::Api::module_exec(int16_t id, ModuleWrapper& module) {
     }
 }
 
+void tv::Api::_module_exec_group(Modules::Group const& group) {
+    if (group.size() == 1 or worker_pool_->size() == 0) {
+        for (auto const& module : group) {
+            module_exec(module.first, *module.second);
+        }
+        return;
+    }
+
+    std::vector<uint8_t> executed(group.size(), false);  // no bit packing
+
+    module_tasks_.clear();
+    for (size_t i = 0; i < group.size(); ++i) {
+        module_tasks_.push_back([this, &group, &executed, i](void) {
+            executed[i] = _module_run(group[i].first, *group[i].second,
+                                      *frame_conversions_);
+        });
+    }
+
+    worker_pool_->run_all(module_tasks_);
+
+    for (size_t i = 0; i < group.size(); ++i) {
+        if (executed[i]) {
+            _module_finish(*group[i].second);
+        }
+    }
+}
+
 void tv::Api::execute(void) {
     Log("API", "Starting main loop");
-
-    auto node_exec = [&](int16_t module_id) {
-        (void)modules_->exec_one(module_id,
-                                 [&module_id, this](ModuleWrapper& module) {
-            module_exec(module_id, module);
+    ThreadPlacement::Scope placement("executor");
+
+    // Executed concurrently for independent branches of the scene trees.
+    // The output image is passed on to the children of the executed node.
+    auto node_exec = [this](int16_t module_id, FrameConversions& input) {
+        Image const* output = nullptr;
+
+        (void)modules_->exec_one(module_id, [&](ModuleWrapper& module) {
+            if (_module_run(module_id, module, input)) {
+                auto& image = module.modified_image();
+                if (image.header.format != ColorSpace::INVALID) {
+                    output = &image;
+                }
+                _module_handle_tags(module);
+            }
             return TV_OK;
         });
+
+        return output;
     };
 
+    // Frames are captured and converted asynchronously, see _capture_frame()
+    if (not pipeline_->start()) {
+        LogError("API", "Could not start the frame pipeline");
+        return;
+    }
+
     // mainloop
-    auto last_loop_time_point = Clock::now();
+    auto& time = TimeSource::instance();
+    auto last_loop_time_point = time.now();
+    auto last_frame_time_point = Clock::time_point();
     auto loops = 0;
     auto loop_duration = Clock::duration(0);
 
     while (active_) {
-        last_loop_time_point = Clock::now();
-        // Log("API", "Execution at ", last_loop_time_point);
+        // sleeps until a frame arrives or _notify_work() is called
+        auto frame = pipeline_->next();
 
-        Image frame;
+        if (not frame) {  // the pipeline might have been idle
+            last_frame_time_point = Clock::time_point();
+            if (paused_ or not active_modules()) {
+                overload_.reset();  // restarts without shedding
+            }
+        } else {
+            if (overload_reset_.exchange(false)) {
+                overload_.reset();
+            }
 
-        if (not paused_ and active_modules()) {  // active_modules() does not
-                                                 // account for modules
-            // being 'stopped', i.e. this is true even if all modules are in
-            // paused state.  Then, camera_control_ will return the last
-            // image retrieved from the camera (and it will be ignored by
-            // update_module anyways)
+            last_loop_time_point = time.now();
+            // Log("API", "Execution at ", last_loop_time_point);
 
-            if (not camera_control_.update_frame(frame)) {
-                LogWarning("API", "Could not retrieve the next frame");
-            } else {
-                conversions_.set_frame(frame);
+            if (last_frame_time_point != Clock::time_point()) {
+                _account_frame_interval(last_loop_time_point -
+                                        last_frame_time_point);
+            }
+            last_frame_time_point = last_loop_time_point;
 
-                if (not _scenes_active()) {
-                    modules_->exec_all();
-                } else {
-                    scene_trees_.exec_all(
-                        node_exec, camera_control_.latest_frame_timestamp());
+            {
+                // the previous frame is kept until now for module_run_now()
+                std::lock_guard<std::mutex> lock(frame_mutex_);
+                if (frame_) {
+                    pipeline_->release(frame_);
                 }
+                frame_ = frame;
+                frame_conversions_ = &frame_->conversions;
             }
 
-            // Propagate deletion of modules marked for removal
-            modules_->remove_if([](ModuleWrapper const& module) {
-                return module.tags() & ModuleWrapper::Tag::Removable;
-            });
+            scheduler_.schedule(*modules_, frame->image().header.timestamp,
+                                overload_);
+
+            // slow modules get the frame on their own thread
+            _exec_async_lanes(*frame);
+
+            if (not _scenes_active()) {
+                // modules outputting an image end a group, since the
+                // following modules depend on it
+                modules_->exec_grouped(
+                    [](ModuleWrapper const& module) {
+                        return module.enabled() and module.outputs_image();
+                    },
+                    [this](Modules::Group const& group) {
+                        _module_exec_group(group);
+                    });
+            } else {
+                scene_trees_.exec_all(node_exec,
+                                      frame->image().header.timestamp,
+                                      *frame_conversions_, *worker_pool_);
+            }
+            _deliver_frame_results();
+
+            auto const frametime = time.now() - last_loop_time_point;
+            auto const budget = Clock::duration(capture_interval_.load());
+            if (overload_.update(frametime, budget)) {
+                _notify_overload(budget);
+            }
 
             loops++;
-            loop_duration += (Clock::now() - last_loop_time_point);
+            loop_duration += frametime;
             if (loops == 10) {
                 effective_frameperiod_ =
                     std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -265,76 +496,235 @@ void tv::Api::execute(void) {
                 loops = 0;
                 loop_duration = Clock::duration(0);
             }
-            // sleep for the duration requested, if it's not in the past
-            std::this_thread::sleep_until(
-                last_loop_time_point +
-                std::chrono::milliseconds(frameperiod_ms_));
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
         }
+
+        // Propagate deletion of modules marked for removal, which must not
+        // be executing asynchronously anymore.  Modules removed before the
+        // lanes were stopped can be released.  Both lock the modules
+        // exclusively, which is avoided unless there is something to do.
+        auto const unlinked = modules_->epoch();
+        _stop_async_lanes(false);
+        if (removals_pending_.exchange(0)) {
+            modules_->remove_if([](ModuleWrapper const& module) {
+                return module.tags() & ModuleWrapper::Tag::Removable;
+            });
+        }
+        if (modules_->reclaimable()) {
+            (void)modules_->reclaim(unlinked);
+        }
+    }
+
+    _stop_async_lanes(true);
+    pipeline_->stop();
+    Log("API", "Mainloop stopped, ", pipeline_->dropped(), " frames dropped");
+}
+
+bool tv::Api::_capture_frame(Image& frame) {
+    _apply_camera_request();
+
+    if (paused_ or not active_modules()) {  // active_modules() does not
+                                            // account for modules
+        // being 'stopped', i.e. this is true even if all modules are in
+        // paused state.  Then, camera_control_ will return the last
+        // image retrieved from the camera (and it will be ignored by
+        // update_module anyways)
+        std::unique_lock<std::mutex> lock(work_mutex_);
+        work_available_.wait(lock, [this](void) {
+            return work_notified_ or not active_ or
+                   (not paused_ and active_modules());
+        });
+        work_notified_ = false;
+        last_capture_time_point_ = Clock::time_point();
+        return false;
+    }
+
+    // If a frameperiod is requested, sleep until the frame_timer_ expires.
+    // Else, the camera blocks until the next frame has arrived.
+    if (not frame_timer_.wait(frameperiod_ms_)) {
+        return false;  // woken by _notify_work()
+    }
+
+    // The capture interval is the time available to process a frame, as
+    // needed by the overload_ control.
+    auto const now = TimeSource::instance().now();
+    if (last_capture_time_point_ != Clock::time_point()) {
+        auto const interval = (now - last_capture_time_point_).count();
+        auto const average = capture_interval_.load();
+        capture_interval_ = average ? (average * 7 + interval) / 8 : interval;
+    }
+    last_capture_time_point_ = now;
+
+    if (not camera_control_.update_frame(frame)) {
+        LogWarning("API", "Could not retrieve the next frame");
+        return false;
+    }
+
+    return true;
+}
+
+int16_t tv::Api::_request_camera_change(std::function<bool(void)> change) {
+
+    if (not executor_.joinable()) {  // camera not running
+        return change() ? TV_OK : TV_CAMERA_SETTINGS_FAILED;
+    }
+
+    /// Else, the capturing stage applies the change before grabbing the next
+    /// frame, see _apply_camera_request().
+    std::unique_lock<std::mutex> lock(camera_request_mutex_);
+    camera_request_ = {change, true, TV_CAMERA_SETTINGS_FAILED};
+    _notify_work();  // the capturing stage may be idle
+
+    auto& time = TimeSource::instance();
+    auto const applied = time.wait_until(
+        lock, camera_request_applied_,
+        time.now() + std::chrono::milliseconds(camera_request_timeout_ms_),
+        [this](void) { return not camera_request_.pending; });
+
+    if (not applied) {
+        camera_request_.pending = false;
+        LogWarning("API", "Camera settings: ", "Mainloop did not respond");
+        return TV_BUSY;
+    }
+
+    return camera_request_.result;
+}
+
+void tv::Api::_load_thread_placements(void) {
+    auto const filename = environment_->user_prefix() + THREADS_FILE;
+    if (not ThreadPlacement::instance().load(filename)) {
+        LogWarning("API", "Thread placements from ", filename,
+                   " not fully applied");
+    }
+}
+
+void tv::Api::_notify_work(void) {
+    {
+        std::lock_guard<std::mutex> lock(work_mutex_);
+        work_notified_ = true;
+    }
+    work_available_.notify_all();
+    frame_timer_.wake();
+    if (pipeline_) {
+        pipeline_->wake();
     }
-    Log("API", "Mainloop stopped");
+}
+
+void tv::Api::_apply_camera_request(void) {
+    std::lock_guard<std::mutex> lock(camera_request_mutex_);
+
+    if (not camera_request_.pending) {
+        return;
+    }
+
+    /// Camera buffers are reallocated here. The conversion targets and the
+    /// output images of the modules follow with the next frame.
+    camera_request_.result =
+        camera_request_.change() ? TV_OK : TV_CAMERA_SETTINGS_FAILED;
+    overload_reset_ = true;  // e.g. the framesize changed
+
+    camera_request_.pending = false;
+    camera_request_.change = nullptr;
+    camera_request_applied_.notify_all();
 }
 
 int16_t tv::Api::module_run_now(int8_t id) {
+    // keep the mainloop from releasing the current frame
+    std::lock_guard<std::mutex> lock(frame_mutex_);
+
     return modules_->exec_one_now(id, [this, id](ModuleWrapper& module) {
         assert(module.enable_at_least_once());
+        module.schedule(true);  // regardless of the Scheduler
         module_exec(id, module);
         return TV_OK;
     });
 }
 
 int16_t tv::Api::module_run_now_new_frame(int8_t id) {
-    return modules_->exec_one_now_restarting(id,
-                                             [this, id](ModuleWrapper& module) {
+    std::lock_guard<std::mutex> run_now_lock(run_now_mutex_);
+
+    // Only the capturing stage may grab from the camera, so it is asked for
+    // a copy of the next frame. This happens before frame_mutex_ is taken,
+    // because the capturing stage may wait for the mainloop.
+    auto const grabbed = _request_camera_change([this](void) {
         Image frame;
-        assert(module.enable_at_least_once());
         if (not camera_control_.update_frame(frame)) {
-            LogWarning("API", "Could not retrieve the next frame");
-            return TV_CAMERA_NOT_AVAILABLE;
+            return false;
+        }
+
+        if (run_now_frame_().header != frame.header) {
+            run_now_frame_.allocate(frame.header, false);
         }
+        run_now_frame_.copy_data(frame.data, frame.header.bytesize);
+        run_now_frame_.image().header.timestamp = frame.header.timestamp;
+        return true;
+    });
+
+    if (grabbed != TV_OK) {
+        LogWarning("API", "Could not retrieve the next frame");
+        return TV_CAMERA_NOT_AVAILABLE;
+    }
+
+    std::lock_guard<std::mutex> lock(frame_mutex_);
 
-        conversions_.set_frame(frame);
+    return modules_->exec_one_now_restarting(id,
+                                             [this, id](ModuleWrapper& module) {
+        assert(module.enable_at_least_once());
+        conversions_.set_frame(run_now_frame_());
+
+        // The mainloop continues with its own frame afterwards.
+        auto const previous = frame_conversions_;
+        frame_conversions_ = &conversions_;
+        module.schedule(true);  // regardless of the Scheduler
         module_exec(id, module);
+        frame_conversions_ = previous;
         return TV_OK;
     });
 }
 
 int16_t tv::Api::set_framesize(uint16_t width, uint16_t height) {
 
-    auto result = TV_CAMERA_SETTINGS_FAILED;
+    /// If the settings can't be applied, any previous ones will be restored.
+    return _request_camera_change([this, width, height](void) {
+        return camera_control_.switch_framesize(width, height);
+    });
+}
+
+int16_t tv::Api::set_capture_region(uint16_t x, uint16_t y, uint16_t width,
+                                    uint16_t height) {
+    FrameRegion region;
+    region.x = x;
+    region.y = y;
+    region.width = width;
+    region.height = width ? height : 0;
+
+    return _request_camera_change([this, region](void) {
+        return camera_control_.switch_region(region);
+    });
+}
+
+int16_t tv::Api::set_decode_scale(uint8_t scale) {
+
+    auto result = TV_INVALID_ARGUMENT;
 
-    /// \todo Count the active modules continuously and remove code dup.
     auto active_count = modules_->count(
         [](tv::ModuleWrapper const& module) { return module.enabled(); });
 
     if (active_count) {
-        uint16_t w, h;
-        camera_control_.get_resolution(w, h);
-
-        if (w != width or h != height) {  // different settings?
-            auto code = stop();
-            if (code != TV_OK) {
-                LogError("API", "SetFramesize ", "Stop returned ", code);
-            }
-
-            /// If the settings can't be applied, any previous ones will
-            /// be restored.
-            if (camera_control_.preselect_framesize(width, height)) {
-                result = TV_OK;
-            }
+        auto code = stop();
+        if (code != TV_OK) {
+            LogError("API", "SetDecodeScale ", "Stop returned ", code);
+        }
 
-            code = start();
-            if (code != TV_OK) {
-                LogError("API", "SetFramesize ", "Start returned ", code);
-            }
-        } else {
+        if (camera_control_.preselect_decode_scale(scale)) {
             result = TV_OK;
         }
-    } else {  // camera not running
-        if (camera_control_.preselect_framesize(width, height)) {
-            result = TV_OK;
+
+        code = start();
+        if (code != TV_OK) {
+            LogError("API", "SetDecodeScale ", "Start returned ", code);
         }
+    } else if (camera_control_.preselect_decode_scale(scale)) {
+        result = TV_OK;
     }
 
     return result;
@@ -368,6 +758,130 @@ int16_t tv::Api::module_load(std::string const& name, int8_t& id) {
     return result;
 }
 
+int16_t tv::Api::set_parameters(int8_t module_id,
+                                ModuleWrapper::ParameterBlock const& values) {
+
+    return modules_->exec_one(module_id, [&](ModuleWrapper& module) {
+        for (auto const& value : values) {
+            if (not module.has_parameter(value.first)) {
+                return TV_MODULE_NO_SUCH_PARAMETER;
+            }
+        }
+        if (not module.stage_parameters(values)) {
+            return TV_MODULE_ERROR_SETTING_PARAMETER;
+        }
+        return TV_OK;
+    });
+}
+
+int16_t tv::Api::parameter_handle(int8_t module_id,
+                                  std::string const& parameter,
+                                  Parameter::Handle& handle) {
+
+    return modules_->exec_one(module_id, [&](ModuleWrapper& module) {
+        if (not module.parameter_handle(parameter, handle)) {
+            return TV_MODULE_NO_SUCH_PARAMETER;
+        }
+        return TV_OK;
+    });
+}
+
+int16_t tv::Api::set_parameter(int8_t module_id, Parameter::Handle parameter,
+                               int32_t value) {
+
+    return modules_->exec_one(module_id, [&](ModuleWrapper& module) {
+        if (not module.has_parameter(parameter)) {
+            return TV_MODULE_NO_SUCH_PARAMETER;
+        }
+        if (not module.set_parameter(parameter, value)) {
+            return TV_MODULE_ERROR_SETTING_PARAMETER;
+        }
+        return TV_OK;
+    });
+}
+
+int16_t tv::Api::get_parameter(int8_t module_id, Parameter::Handle parameter,
+                               int32_t& value) {
+
+    return modules_->exec_one(module_id, [&](ModuleWrapper& module) {
+        if (not module.get_parameter(parameter, value)) {
+            return TV_MODULE_NO_SUCH_PARAMETER;
+        }
+        return TV_OK;
+    });
+}
+
+int16_t tv::Api::module_load_async(std::string const& name, int8_t& id) {
+    auto module_id = _next_public_id();
+
+    assert(module_id < std::numeric_limits<int8_t>::max() and module_id > 0);
+    id = static_cast<int8_t>(module_id);
+
+    {
+        std::lock_guard<std::mutex> lock(loads_mutex_);
+        load_status_[id] = TV_MODULE_LOADING;
+        loads_pending_++;
+    }
+
+    std::thread([this, name, module_id](void) {
+        auto result = _module_load(name, module_id, true);
+        if (TV_INVALID_ID == result) {
+            result = TV_INTERNAL_ERROR;  // see module_load()
+        }
+
+        auto const id = static_cast<int8_t>(module_id);
+        Log("API", "Loaded ", name, " as ", module_id, ": ", result);
+        TV_ModuleLoadedCallback callback;
+        void* context;
+        {
+            std::lock_guard<std::mutex> lock(loads_mutex_);
+            load_status_[id] = result;
+            callback = loaded_callback_;
+            context = loaded_context_;
+        }
+
+        if (callback) {
+            callback(id, result, context);
+        }
+
+        std::lock_guard<std::mutex> lock(loads_mutex_);
+        loads_pending_--;
+        loads_done_.notify_all();
+    }).detach();
+
+    return TV_OK;
+}
+
+int16_t tv::Api::module_load_status(int8_t id) {
+    auto status = TV_OK;
+    {
+        std::lock_guard<std::mutex> lock(loads_mutex_);
+        auto const it = load_status_.find(id);
+        if (it != load_status_.end()) {
+            status = it->second;
+        }
+    }
+
+    // loaded, but might have been removed since
+    if (status == TV_OK and not modules_->managed(id)) {
+        return TV_INVALID_ID;
+    }
+    return status;
+}
+
+int16_t tv::Api::module_loaded_callback(TV_ModuleLoadedCallback callback,
+                                        void* context) {
+    std::lock_guard<std::mutex> lock(loads_mutex_);
+    loaded_context_ = context;
+    loaded_callback_ = callback;
+    return TV_OK;
+}
+
+void tv::Api::_wait_for_loads(void) {
+    std::unique_lock<std::mutex> lock(loads_mutex_);
+    loads_done_.wait(lock, [this](void) { return loads_pending_ == 0; });
+}
+
 int16_t tv::Api::module_destroy(int8_t id) {
     Log("API", "Destroying module ", id);
 
@@ -384,8 +898,9 @@ int16_t tv::Api::module_destroy(int8_t id) {
     /// probably not.
     return modules_->exec_one_now(id, [this](tv::ModuleWrapper& module) {
         module.disable();
-        module.tag(ModuleWrapper::Tag::Removable);
+        _module_removable(module);
         camera_control_.release();
+        _notify_work();  // the mainloop removes the module
         return TV_OK;
     });
 }
@@ -436,6 +951,7 @@ int16_t tv::Api::resolution(uint16_t& width, uint16_t& height) {
 
 int16_t tv::Api::request_frameperiod(uint32_t ms) {
     frameperiod_ms_ = ms;
+    _notify_work();  // rearms the frame_timer_
     return TV_OK;
 }
 
@@ -496,6 +1012,65 @@ int16_t tv::Api::library_describe_parameter(std::string const& libname,
     return TV_OK;
 }
 
+int16_t tv::Api::library_describe_parameters(
+    std::string const& libname, TV_ParameterDescription parameters[],
+    uint16_t capacity, uint16_t& count) {
+
+    if (not module_loader_->library_parameter_count(libname, count)) {
+        return TV_INVALID_ARGUMENT;
+    }
+
+    Parameter const* p;
+    for (uint16_t i = 0; i < count and i < capacity; ++i) {
+        if (not module_loader_->library_get_parameter(libname, i, &p)) {
+            return TV_INVALID_ARGUMENT;  // library changed meanwhile
+        }
+        _describe_parameter(*p, parameters[i]);
+    }
+    return TV_OK;
+}
+
+int16_t tv::Api::module_describe_parameters(
+    int8_t module_id, TV_ParameterDescription parameters[], uint16_t capacity,
+    uint16_t& count) {
+
+    return modules_->exec_one(module_id, [&](ModuleWrapper& module) {
+        std::vector<Parameter const*> list;
+        module.get_parameters_list(list);
+
+        count = static_cast<uint16_t>(list.size());
+        for (uint16_t i = 0; i < count and i < capacity; ++i) {
+            _describe_parameter(*list[i], parameters[i]);
+        }
+        return TV_OK;
+    });
+}
+
+void tv::Api::_describe_parameter(Parameter const& parameter,
+                                  TV_ParameterDescription& description) {
+    auto const copy = [](std::string const& string, char target[]) {
+        std::strncpy(target, string.c_str(), TV_STRING_SIZE - 1);
+        target[TV_STRING_SIZE - 1] = '\0';
+    };
+
+    copy(parameter.name(), description.name);
+    description.min = description.max = description.value = 0;
+    description.string[0] = '\0';
+
+    if (parameter.type() == Parameter::Type::String) {
+        description.type = 1;
+        std::string value;
+        (void)parameter.get(value);
+        copy(value, description.string);
+
+    } else {
+        description.type = 0;
+        description.min = parameter.min();
+        description.max = parameter.max();
+        (void)parameter.get(description.value);
+    }
+}
+
 int16_t tv::Api::module_enumerate_parameters(int8_t module_id,
                                              TV_StringCallback callback,
                                              void* context) const {
@@ -538,6 +1113,10 @@ int16_t tv::Api::set_user_paths_prefix(std::string const& path) {
     (void)module_loader_->switch_user_load_path(
         old_modules_path, environment_->user_modules_path());
 
+    if (result) {
+        _load_thread_placements();
+    }
+
     return result ? TV_OK : TV_INVALID_ARGUMENT;
 }
 
@@ -572,18 +1151,11 @@ int16_t tv::Api::callback_default(TV_Callback callback) {
 
 int16_t tv::Api::get_result(int8_t module_id, TV_ModuleResult& result) {
 
-    return modules_->exec_one_now(module_id, [&](ModuleWrapper& module) {
-        auto res = module.result();
-        if (not res) {
+    // the result is read concurrently, without interrupting the mainloop
+    return modules_->exec_one(module_id, [&](ModuleWrapper& module) {
+        if (not module.result(result)) {
             return TV_RESULT_NOT_AVAILABLE;
         }
-
-        result.x = res.x;
-        result.y = res.y;
-        result.width = res.width;
-        result.height = res.height;
-        std::strncpy(result.string, res.result.c_str(), TV_STRING_SIZE - 1);
-        result.string[TV_STRING_SIZE - 1] = '\0';
         return TV_OK;
     });
 }
@@ -592,6 +1164,149 @@ uint32_t tv::Api::effective_frameperiod(void) const {
     return effective_frameperiod_;
 }
 
+int16_t tv::Api::overload_callback(TV_OverloadCallback callback,
+                                   void* context) {
+    std::lock_guard<std::mutex> lock(overload_callback_mutex_);
+    overload_context_ = context;
+    overload_callback_ = callback;
+    return TV_OK;
+}
+
+void tv::Api::_notify_overload(Clock::duration budget) {
+    TV_OverloadCallback callback;
+    void* context;
+    {
+        std::lock_guard<std::mutex> lock(overload_callback_mutex_);
+        callback = overload_callback_;
+        context = overload_context_;
+    }
+
+    if (not callback) {
+        return;
+    }
+
+    using std::chrono::milliseconds;
+    using std::chrono::duration_cast;
+    callback(overload_.level(),
+             duration_cast<milliseconds>(overload_.frametime()).count(),
+             duration_cast<milliseconds>(budget).count(), context);
+}
+
+int16_t tv::Api::frame_callback(TV_FrameCallback callback, void* context) {
+    std::lock_guard<std::mutex> lock(frame_callback_mutex_);
+    frame_context_ = context;
+    frame_callback_ = callback;
+    modules_->exec_all([callback](int16_t id, ModuleWrapper& module) {
+        module.bundle_results(callback != nullptr);
+    });
+    return TV_OK;
+}
+
+void tv::Api::_deliver_frame_results(void) {
+    TV_FrameCallback callback;
+    void* context;
+    {
+        std::lock_guard<std::mutex> lock(frame_callback_mutex_);
+        callback = frame_callback_;
+        context = frame_context_;
+    }
+
+    if (not callback) {
+        return;
+    }
+
+    frame_results_.clear();
+    TV_FrameResult result;
+    modules_->exec_all([this, &result](int16_t id, ModuleWrapper& module) {
+        if (module.take_bundled(result)) {
+            frame_results_.push_back(result);
+        }
+    });
+
+    if (not frame_results_.empty()) {
+        (void)callback_dispatcher_->post(callback, frame_results_, context);
+    }
+}
+
+int16_t tv::Api::overload_state(uint8_t& level, uint32_t& frametime) const {
+    level = overload_.level();
+    frametime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    overload_.frametime()).count();
+    return TV_OK;
+}
+
+int16_t tv::Api::thread_placement(std::string const& role, uint32_t cpus,
+                                  uint8_t priority, int8_t nice) {
+    if (role.empty() or priority > 99 or nice < -20 or nice > 19) {
+        return TV_INVALID_ARGUMENT;
+    }
+
+    ThreadPlacement::Placement placement;
+    placement.cpus = cpus;
+    placement.priority = priority;
+    placement.nice = nice;
+
+    return ThreadPlacement::instance().place(role, placement)
+               ? TV_OK
+               : TV_THREAD_PLACEMENT_FAILED;
+}
+
+int16_t tv::Api::frame_jitter(uint32_t& interval_us,
+                              uint32_t& jitter_us) const {
+    interval_us = frame_interval_us_;
+    jitter_us = frame_jitter_us_;
+    return TV_OK;
+}
+
+int16_t tv::Api::callbacks_dropped(uint32_t& dropped) const {
+    auto const count = callback_dispatcher_->dropped();
+    dropped = static_cast<uint32_t>(
+        std::min<uint64_t>(count, std::numeric_limits<uint32_t>::max()));
+    return TV_OK;
+}
+
+int16_t tv::Api::executor_wait_limit(uint32_t milliseconds) {
+    modules_->interrupt_timeout(std::chrono::milliseconds(milliseconds));
+    return TV_OK;
+}
+
+int16_t tv::Api::executor_waits(uint32_t& waits, uint32_t& timeouts,
+                                uint32_t& average_us,
+                                uint32_t& longest_us) const {
+    auto const saturated = [](uint64_t value) {
+        return static_cast<uint32_t>(
+            std::min<uint64_t>(value, std::numeric_limits<uint32_t>::max()));
+    };
+
+    auto const statistics = modules_->wait_statistics();
+    waits = saturated(statistics.waits);
+    timeouts = saturated(statistics.timeouts);
+    average_us = statistics.waits ? saturated(statistics.total.count() /
+                                              statistics.waits)
+                                  : 0;
+    longest_us = saturated(statistics.longest.count());
+    return TV_OK;
+}
+
+void tv::Api::_account_frame_interval(Clock::duration interval) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    auto const current = duration_cast<microseconds>(interval).count();
+    int64_t const average = frame_interval_us_;
+    int64_t const jitter = frame_jitter_us_;
+
+    if (not average) {
+        frame_interval_us_ = current;
+        return;
+    }
+
+    // Both are smoothed like the interarrival jitter of RFC 3550.
+    auto const deviation = std::abs(current - average);
+    frame_jitter_us_ = jitter + (deviation - jitter) / 16;
+    frame_interval_us_ = average + (current - average) / 16;
+}
+
 std::string const& tv::Api::user_paths_prefix(void) const {
     return environment_->user_prefix();
 }
@@ -622,15 +1337,16 @@ bool tv::Api::library_get_name_and_path(uint16_t count, std::string& name,
  * Private methods
  */
 
-int16_t tv::Api::_module_load(std::string const& name, int16_t id) {
+int16_t tv::Api::_module_load(std::string const& name, int16_t id,
+                              bool wait) {
     Log("API", "ModuleLoad ", name, " ", id);
 #ifndef DEFAULT_CALL
     uint16_t ms = DELAY_GRAIN * (GRAINS - 2);
 #else
     uint16_t ms = 1000;
 #endif
-    auto start = std::chrono::steady_clock::now();
-    auto maxend = start + std::chrono::milliseconds(ms);
+    auto& time = TimeSource::instance();
+    auto maxend = time.now() + std::chrono::milliseconds(ms);
 
     if ((*modules_)[id]) {
         return TV_INVALID_ID;
@@ -647,49 +1363,77 @@ int16_t tv::Api::_module_load(std::string const& name, int16_t id) {
         module_loader_->destroy_module(module);
         return TV_MODULE_INITIALIZATION_FAILED;
     }
+    module->dispatch_callbacks(callback_dispatcher_);
+    {
+        std::lock_guard<std::mutex> lock(frame_callback_mutex_);
+        module->bundle_results(frame_callback_ != nullptr);
+    }
 
     if (not camera_control_.acquire()) {
+        module_loader_->destroy_module(module);
         return TV_CAMERA_NOT_AVAILABLE;
     }
 
     // Add modules to managed objects and register destruction handler
+    auto inserted = std::make_shared<Completion>();
     std::thread(
-        [this, module, id](void) {
-            if (not modules_->insert(id, module, [this](ModuleWrapper& module) {
+        [this, module, id, inserted](void) {
+            auto const succeeded =
+                modules_->insert(id, module, [this](ModuleWrapper& module) {
                     module_loader_->destroy_module(&module);
-                })) {
+                });
 
+            if (not succeeded) {
                 camera_control_.release();
                 LogError("API", "Inserting a module failed");
-                return;
-                // return TV_MODULE_INITIALIZATION_FAILED;
             }
-            done_.test_and_set();
+            {
+                std::lock_guard<std::mutex> lock(inserted->mutex);
+                inserted->succeeded = succeeded;
+                inserted->done = true;
+            }
+            inserted->completed.notify_all();
         }).detach();
 
-    std::this_thread::sleep_until(maxend);
-    if (done_.test_and_set()) {  // module loaded
-        std::thread([this, module](void) {
-                        /// Add the default callback to each new module
-                        if (default_callback_) {
-                            module->register_callback(default_callback_);
-                        }
+    std::unique_lock<std::mutex> lock(inserted->mutex);
+    auto const done = [&inserted](void) { return inserted->done; };
+    if (wait) {
+        inserted->completed.wait(lock, done);
 
-                        /// \todo Catch the cases in which this fails and remove
-                        /// the
-                        /// module.
-                        (void)module->enable();
-                    }).detach();
-        return TV_OK;
-    } else {
+    } else if (not time.wait_until(lock, inserted->completed, maxend, done)) {
         std::thread([this, id](void) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(
-                            2000));  // should be loaded now
+                        TimeSource::instance().sleep_for(
+                            std::chrono::milliseconds(
+                                2000));  // should be loaded now
                         module_destroy(id);
                     }).detach();
 
         return TV_BUSY;
     }
+
+    if (not inserted->succeeded) {
+        module_loader_->destroy_module(module);
+        return TV_MODULE_INITIALIZATION_FAILED;
+    }
+
+    auto const enable = [this, module](void) {
+        /// Add the default callback to each new module
+        if (default_callback_) {
+            module->register_callback(default_callback_);
+        }
+
+        /// \todo Catch the cases in which this fails and remove the module.
+        (void)module->enable();
+        _notify_work();
+    };
+
+    // A waiting caller reports the module as loaded, so it must be enabled.
+    if (wait) {
+        enable();
+    } else {
+        std::thread(enable).detach();
+    }
+    return TV_OK;
 }
 
 void tv::Api::_disable_all_modules(void) {
@@ -701,6 +1445,7 @@ void tv::Api::_disable_all_modules(void) {
         camera_control_.release();
     });
     paused_ = false;
+    _notify_work();
 }
 
 void tv::Api::_disable_module_if(
@@ -716,6 +1461,7 @@ void tv::Api::_disable_module_if(
             }
         });
     paused_ = false;
+    _notify_work();
 }
 
 void tv::Api::_enable_all_modules(void) {
@@ -729,12 +1475,14 @@ void tv::Api::_enable_all_modules(void) {
         }
     });
     paused_ = false;
+    _notify_work();
 }
 
 int16_t tv::Api::_enable_module(int16_t id) {
     return modules_->exec_one_now(id, [this](tv::ModuleWrapper& module) {
         if (module.enabled() or camera_control_.acquire()) {
             module.enable();  // possibly redundant
+            _notify_work();
             return TV_OK;
         } else {
             return TV_CAMERA_NOT_AVAILABLE;
@@ -751,6 +1499,8 @@ int16_t tv::Api::_disable_module(int16_t id) {
 }
 
 int16_t tv::Api::_next_public_id(void) const {
+    // module_load_async() and the ApiWorker may request ids concurrently
+    std::lock_guard<std::mutex> lock(ids_mutex_);
     static int8_t public_id{0};
     if (++public_id == 0) {
         public_id = 1;
@@ -760,6 +1510,7 @@ int16_t tv::Api::_next_public_id(void) const {
 }
 
 int16_t tv::Api::_next_internal_id(void) const {
+    std::lock_guard<std::mutex> lock(ids_mutex_);
     static int16_t internal_id{std::numeric_limits<int8_t>::max() + 1};
     return internal_id++;
 }
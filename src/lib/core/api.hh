@@ -27,12 +27,15 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <typeinfo>
 #include <limits>
 #include <functional>
 #include <algorithm>
 #include <tuple>
 #include <cstring>
+#include <map>
+#include <memory>
 
 #include "strings.hh"
 #include "tinkervision_defines.h"
@@ -42,6 +45,15 @@
 #include "module_loader.hh"
 #include "shared_resource.hh"
 #include "environment.hh"
+#include "worker_pool.hh"
+#include "frame_timer.hh"
+#include "thread_placement.hh"
+#include "time_source.hh"
+#include "frame_pipeline.hh"
+#include "scheduler.hh"
+#include "overload_controller.hh"
+#include "async_lane.hh"
+#include "callback_dispatcher.hh"
 #include "logger.hh"
 
 namespace tv {
@@ -116,12 +128,36 @@ public:
     /// \return #TV_NOT_IMPLEMENTED
     int16_t module_run_now_new_frame(int8_t id);
 
-    /// Set the framesize.
+    /// Set the framesize.  If the mainloop is running, the change is applied
+    /// by the mainloop between two frames, without stopping any module.
+    /// Modules get to know about the new framesize from the header passed to
+    /// get_output_image_header() and execute().
     /// \return
     /// - #TV_CAMERA_SETTINGS_FAILED if the selected size is not valid.
+    /// - #TV_BUSY if the mainloop did not get to apply the change in time.
     /// - #TV_OK else
     int16_t set_framesize(uint16_t width, uint16_t height);
 
+    /// Set the scale applied when decoding compressed camera frames.
+    /// \return
+    /// - #TV_INVALID_ARGUMENT if the scale is not one of 1, 2, 4, 8.
+    /// - #TV_OK else
+    int16_t set_decode_scale(uint8_t scale);
+
+    /// Select the region of the camera frames to be captured, see
+    /// set_framesize() on how this is applied.  All modules will only get
+    /// to see this region.
+    /// \param[in] x Left of the region.
+    /// \param[in] y Top of the region.
+    /// \param[in] width Width of the region, or 0 to capture the full frame.
+    /// \param[in] height Height of the region.
+    /// \return
+    /// - #TV_CAMERA_SETTINGS_FAILED if the region does not fit the frames.
+    /// - #TV_BUSY if the mainloop did not get to apply the change in time.
+    /// - #TV_OK else
+    int16_t set_capture_region(uint16_t x, uint16_t y, uint16_t width,
+                               uint16_t height);
+
     /// Start an idle process, i.e. a module which will never be
     /// executed.  This is a lightweight module which will not trigger
     /// frame grabbing.  However, once started, it will keep the camera
@@ -138,6 +174,32 @@ public:
     /// Load a module by its basename under the given id.
     int16_t module_load(std::string const& name, int8_t& id);
 
+    /// Load a module by its basename on a thread of its own, so that several
+    /// modules can be loaded in parallel.  The id is valid immediately, but
+    /// the module can only be used once module_load_status() is #TV_OK.
+    /// \param[in] name Basename of the library.
+    /// \param[out] id Id of the module.
+    /// \return #TV_OK
+    int16_t module_load_async(std::string const& name, int8_t& id);
+
+    /// Get the state of a module loaded by module_load_async().
+    /// \param[in] id Id of the module.
+    /// \return
+    /// - #TV_MODULE_LOADING while the module is loaded.
+    /// - #TV_INVALID_ID if no such module exists (anymore).
+    /// - #TV_OK if the module has been loaded and started.
+    /// - The error of module_load() else.
+    int16_t module_load_status(int8_t id);
+
+    /// Set a callback notified whenever module_load_async() completes.
+    /// \param[in] callback Receives the id, the result as returned by
+    /// module_load_status() and context, from the loading thread.  Pass
+    /// nullptr to unregister.
+    /// \param[in] context Passed to the callback.
+    /// \return #TV_OK
+    int16_t module_loaded_callback(TV_ModuleLoadedCallback callback,
+                                   void* context);
+
     /// Deactivate and remove a module.
     /// \return
     ///   - #TV_NOT_IMPLEMENTED if scenes are active
@@ -170,6 +232,50 @@ public:
         });
     }
 
+    /// Set several numerical parameters of a module at once, see
+    /// ModuleWrapper::stage_parameters().
+    /// \param[in] module_id Id of a loaded module (may be inactive).
+    /// \param[in] values The parameters and their values.
+    /// \return
+    ///    - #TV_NO_SUCH_PARAMETER if a parameter does not exist
+    ///    - #TV_MODULE_ERROR_SETTING_PARAMETER if a value is incompatible
+    ///    - #TV_OK else
+    int16_t set_parameters(int8_t module_id,
+                           ModuleWrapper::ParameterBlock const& values);
+
+    /// Get the handle of a parameter of a module, which can be used with
+    /// set_parameter() and get_parameter() instead of the name.
+    /// \param[in] module_id Id of a loaded module (may be inactive).
+    /// \param[in] parameter Name of the parameter.
+    /// \param[out] handle Handle of the parameter.
+    /// \return
+    ///    - #TV_NO_SUCH_PARAMETER if the parameter does not exist
+    ///    - #TV_OK else
+    int16_t parameter_handle(int8_t module_id, std::string const& parameter,
+                             Parameter::Handle& handle);
+
+    /// Set a numerical parameter of a module by its handle.
+    /// \param[in] module_id Id of a loaded module (may be inactive).
+    /// \param[in] parameter Handle of the parameter, see parameter_handle().
+    /// \param[in] value Value to set.
+    /// \return
+    ///    - #TV_NO_SUCH_PARAMETER if the parameter does not exist
+    ///    - #TV_MODULE_ERROR_SETTING_PARAMETER if the value is incompatible
+    ///    - #TV_OK else
+    int16_t set_parameter(int8_t module_id, Parameter::Handle parameter,
+                          int32_t value);
+
+    /// Get a numerical parameter's value from a module by its handle.
+    /// \param[in] module_id Id of a loaded module (may be inactive).
+    /// \param[in] parameter Handle of the parameter, see parameter_handle().
+    /// \param[out] value Value of parameter.
+    /// \return
+    ///    - #TV_NO_SUCH_PARAMETER if the parameter does not exist or is not
+    ///    numerical
+    ///    - #TV_OK else
+    int16_t get_parameter(int8_t module_id, Parameter::Handle parameter,
+                          int32_t& value);
+
     /// Get a parameter's value from a module. T can be int32_t or
     /// std::string.
     /// \param[in] module_id Id of a loaded module (may be inactive).
@@ -324,6 +430,34 @@ public:
                                        uint8_t& type, int32_t& min,
                                        int32_t& max, int32_t& def);
 
+    /// Describe all parameters of a library module at once, with their
+    /// default values.
+    /// \param[in] libname Name of the library w/o extension.
+    /// \param[out] parameters Receives up to capacity descriptions.
+    /// \param[in] capacity Size of parameters.
+    /// \param[out] count Number of parameters of the library, which might
+    /// exceed capacity.
+    /// \return
+    ///    - #TV_INVALID_ARGUMENT if no such library is loadable.
+    ///    - #TV_OK else
+    int16_t library_describe_parameters(std::string const& libname,
+                                        TV_ParameterDescription parameters[],
+                                        uint16_t capacity, uint16_t& count);
+
+    /// Describe all parameters of a module at once, with their current
+    /// values.
+    /// \param[in] module_id Id of a loaded module (may be inactive).
+    /// \param[out] parameters Receives up to capacity descriptions.
+    /// \param[in] capacity Size of parameters.
+    /// \param[out] count Number of parameters of the module, which might
+    /// exceed capacity.
+    /// \return
+    ///    - #TV_INVALID_ID if the module does not exist
+    ///    - #TV_OK else
+    int16_t module_describe_parameters(int8_t module_id,
+                                       TV_ParameterDescription parameters[],
+                                       uint16_t capacity, uint16_t& count);
+
     /// Register a callback to enumerate all parameters of a module.
     /// \deprecated Not used in Tinkerforge context.
     int16_t module_enumerate_parameters(int8_t module_id,
@@ -369,7 +503,8 @@ public:
     /// \todo Implement method unregister_callback in redbrickapid.
     int16_t callback_default(TV_Callback callback);
 
-    /// Get the latest result from a module.
+    /// Get the latest result from a module.  This does not wait for the
+    /// mainloop, the result is copied from the module's ResultSlot.
     /// \param[in] module_id Id of an active module.
     /// \param[out] result Result provided by the module.
     /// \note You need to check the return value to see if result is valid.
@@ -384,6 +519,85 @@ public:
     /// \see request_frameperiod()
     uint32_t effective_frameperiod(void) const;
 
+    /// Set a callback notified about each change of the overload shedding
+    /// level.  If processing a frame repeatedly takes longer than the
+    /// interval in which frames are captured, the rates of modules with a
+    /// priority below OverloadController::critical_priority are halved per
+    /// level. The callback is run from the execution thread.
+    /// \param[in] callback Receives the new level, the averaged time
+    /// needed per frame and the time available per frame, both in
+    /// milliseconds, and context. Pass nullptr to unregister.
+    /// \param[in] context Passed to the callback.
+    /// \return #TV_OK
+    int16_t overload_callback(TV_OverloadCallback callback, void* context);
+
+    /// Register a callback receiving the results of all modules at once,
+    /// after each frame which produced any.  Results of modules executed
+    /// asynchronously are delivered with the next frame finished in the
+    /// mainloop.
+    /// \param[in] callback Called from the thread of the
+    /// CallbackDispatcher, nullptr to unregister.
+    /// \param[in] context Passed to the callback.
+    /// \return #TV_OK
+    int16_t frame_callback(TV_FrameCallback callback, void* context);
+
+    /// Retrieve the current overload state.
+    /// \param[out] level The shedding level, 0 if nothing is shed.
+    /// \param[out] frametime The averaged time in milliseconds needed per
+    /// frame.
+    /// \return #TV_OK
+    int16_t overload_state(uint8_t& level, uint32_t& frametime) const;
+
+    /// Place the threads of a role on CPUs and set their scheduling policy,
+    /// see ThreadPlacement for the roles.  Placements are also read from the
+    /// file #THREADS_FILE in the user prefix, whenever that is set.
+    /// \param[in] role Name of the role, e.g. executor.
+    /// \param[in] cpus Bitmask of the CPUs allowed, 0 for all.
+    /// \param[in] priority 1 to 99 to run under SCHED_FIFO with that
+    /// priority, 0 for SCHED_OTHER.
+    /// \param[in] nice Nice level -20 to 19, applied under SCHED_OTHER.
+    /// \return
+    /// - #TV_INVALID_ARGUMENT if a value is out of range.
+    /// - #TV_THREAD_PLACEMENT_FAILED if the placement could not be applied
+    /// to each running thread of role, e.g. without the privileges needed.
+    /// It is kept anyways.
+    /// - #TV_OK else.
+    int16_t thread_placement(std::string const& role, uint32_t cpus,
+                             uint8_t priority, int8_t nice);
+
+    /// Retrieve the realised interval between frames reaching the mainloop
+    /// and its jitter, both smoothed over the last frames.
+    /// \param[out] interval_us Average interval in microseconds.
+    /// \param[out] jitter_us Average deviation from interval_us in
+    /// microseconds.
+    /// \return #TV_OK
+    int16_t frame_jitter(uint32_t& interval_us, uint32_t& jitter_us) const;
+
+    /// Retrieve the number of results not passed to a callback, see
+    /// CallbackDispatcher.
+    /// \param[out] dropped Results dropped so far, saturated.
+    /// \return #TV_OK
+    int16_t callbacks_dropped(uint32_t& dropped) const;
+
+    /// Limit the time calls executing a module right away wait for the
+    /// mainloop to finish the module it is executing, see
+    /// SharedResource::interrupt_timeout().  Such calls return #TV_BUSY if
+    /// the limit is exceeded.
+    /// \param[in] milliseconds The limit, 0 for none.
+    /// \return #TV_OK
+    int16_t executor_wait_limit(uint32_t milliseconds);
+
+    /// Retrieve how long calls executing a module right away waited for the
+    /// mainloop, see SharedResource::wait_statistics().  The values are
+    /// saturated.
+    /// \param[out] waits Calls which had to wait.
+    /// \param[out] timeouts Calls which exceeded the limit.
+    /// \param[out] average_us Average waiting time of those which waited.
+    /// \param[out] longest_us Longest waiting time.
+    /// \return #TV_OK
+    int16_t executor_waits(uint32_t& waits, uint32_t& timeouts,
+                           uint32_t& average_us, uint32_t& longest_us) const;
+
     /// Retrieve the current user path.
     /// \see set_user_paths_prefix().
     /// \return The path holding the directory structure for user files.
@@ -468,19 +682,73 @@ private:
                        noexcept(FrameConversions()) and noexcept(Strings()) and
                        noexcept(SceneTrees()));
 
-    std::atomic_flag done_{ATOMIC_FLAG_INIT};  ///< Used to synchronize long
-    /// lasting operations, in particular _module_load()
+    /// Used to synchronize long lasting operations, in particular
+    /// _module_load()
+    struct Completion {
+        std::mutex mutex;
+        std::condition_variable completed;
+        bool done{false};
+        bool succeeded{false};  ///< Outcome of the operation, once done
+    };
 
     CameraControl camera_control_;  ///< Camera access abstraction
-    FrameConversions conversions_;  ///< Camera frame in requested formats
+    FrameConversions conversions_;  ///< Frames not passing the pipeline_
+    ImageAllocator run_now_frame_{"Api/RunNow"};  ///< Copy for conversions_
+    std::mutex run_now_mutex_;  ///< Serializes module_run_now_new_frame()
     Strings result_string_map_;     ///< String mapping of Api-return values
     SceneTrees scene_trees_;
+    Scheduler scheduler_;  ///< Decides which modules run in a frame
+    OverloadController overload_;  ///< Sheds modules if frames overrun
+    std::atomic<bool> overload_reset_{false};  ///< Set on a camera change,
+    /// since the measured times don't apply anymore
+    std::atomic<Clock::rep> capture_interval_{0};  ///< Averaged, in
+    /// Clock::duration ticks, the time available to process a frame
+    TV_OverloadCallback overload_callback_{nullptr};
+    void* overload_context_{nullptr};
+    std::mutex overload_callback_mutex_;  ///< Guards overload_callback_,
+    /// overload_context_
+    TV_FrameCallback frame_callback_{nullptr};
+    void* frame_context_{nullptr};
+    std::mutex frame_callback_mutex_;  ///< Guards frame_callback_, _context_
+    std::atomic<uint32_t> removals_pending_{0};  ///< Modules tagged
+    /// Removable since the mainloop removed modules last
+    TV_ModuleLoadedCallback loaded_callback_{nullptr};
+    void* loaded_context_{nullptr};
+
+    std::mutex loads_mutex_;  ///< Guards load_status_, loads_pending_ and
+                              /// loaded_callback_ with loaded_context_
+    std::condition_variable loads_done_;  ///< Signals loads_pending_
+    std::map<int8_t, int16_t> load_status_;  ///< See module_load_status()
+    size_t loads_pending_{0};  ///< Threads of module_load_async() running
+    mutable std::mutex ids_mutex_;  ///< Guards the generation of module ids
+    std::vector<TV_FrameResult> frame_results_;  ///< Reused by the mainloop
+
+    std::atomic<uint32_t> frame_interval_us_{0};  ///< See frame_jitter()
+    std::atomic<uint32_t> frame_jitter_us_{0};    ///< See frame_jitter()
+
+    std::map<int16_t, std::unique_ptr<AsyncLane>> async_lanes_;  ///< Of
+    /// the modules executed asynchronously, accessed by the mainloop only
+    std::vector<AsyncLane::SharedFrame> shared_frames_;  ///< Copies of
+    /// frames for the async_lanes_, reused once no lane holds them
 
     Environment* environment_;     ///< Configuration and scripting context
     Modules* modules_;             ///< RAII-style managed vision algorithms.
     ModuleLoader* module_loader_;  ///< Manages available libraries
-
-    Image image_;  ///< Current frame in requested format
+    WorkerPool* worker_pool_{nullptr};  ///< Executes independent modules
+    CallbackDispatcher* callback_dispatcher_{nullptr};  ///< Calls back
+    WorkerPool::Tasks module_tasks_;    ///< Reused by _module_exec_group()
+
+    FramePipeline* pipeline_{nullptr};  ///< Captures and converts frames
+    FramePipeline::Frame* frame_{nullptr};  ///< Latest frame of pipeline_
+    FrameConversions* frame_conversions_{&conversions_};  ///< Current frame
+    /// in requested formats, usually those of frame_
+    std::mutex frame_mutex_;  ///< Keeps frame_ while executing out of order
+    Clock::time_point last_capture_time_point_;  ///< Last frame captured
+    FrameTimer frame_timer_;  ///< Throttles capturing to frameperiod_ms_
+
+    std::mutex work_mutex_;  ///< Guards work_notified_
+    std::condition_variable work_available_;  ///< Wakes the idle capturing
+    bool work_notified_{false};  ///< Set by _notify_work()
 
     bool api_valid_{false};  ///< True once constructed to valid state.
     bool idle_process_running_{false};   ///< Dummy module activated?
@@ -493,21 +761,153 @@ private:
 
     TV_Callback default_callback_ = nullptr;
 
+    /// A change of the camera settings requested e.g. from set_framesize(),
+    /// to be applied by the mainloop.
+    struct CameraRequest {
+        std::function<bool(void)> change;  ///< Returns false if it failed
+        bool pending;
+        int16_t result;
+    };
+
+    CameraRequest camera_request_{nullptr, false, TV_OK};
+    std::mutex camera_request_mutex_;  ///< Protects camera_request_
+    std::condition_variable camera_request_applied_;  ///< pending = false
+    static const uint16_t camera_request_timeout_ms_ = 2000;
+
     bool active(void) const { return active_; }
     bool active_modules(void) const { return modules_->size(); }
 
+    /// Read the placements of the library's threads from the user prefix.
+    void _load_thread_placements(void);
+
+    /// Update the frame_interval_us_ and frame_jitter_us_.
+    /// \param[in] interval Time since the previous frame.
+    void _account_frame_interval(Clock::duration interval);
+
+    /// Collect the results produced since the previous frame and post them
+    /// to the frame_callback_, if any.
+    void _deliver_frame_results(void);
+
+    /// Pass the current overload_ state to the overload_callback_, if any.
+    /// \param[in] budget The time available to process a frame.
+    void _notify_overload(Clock::duration budget);
+
+    /// Wake the capturing stage, if idle or throttled, and the mainloop, if
+    /// waiting for a frame, to reconsider their state.  Called after each
+    /// change which may produce work, e.g. a module becoming active, and on
+    /// stop.
+    void _notify_work(void);
+
     /// Only context from which modules are executed.
+    /// Equivalent to _module_run() followed by _module_finish().
     void module_exec(int16_t id, ModuleWrapper& module);
     friend Modules;
 
+    /// Execute a module on the current frame, if it is enabled.  This may be
+    /// run concurrently for different modules as long as none of them
+    /// outputs an image.
+    /// \param[in] id Id of the module.
+    /// \param[in] module The module.
+    /// \param[in] conversions Provide the frame in the format required.
+    /// \return False if the module crashed and has been tagged Removable.
+    bool _module_run(int16_t id, ModuleWrapper& module,
+                     FrameConversions& conversions);
+
+    /// Publish the output image of a module executed by _module_run() and
+    /// handle its runtime tags.  Must be called from the mainloop only, in
+    /// the order of execution.
+    /// \param[in] module The module.
+    void _module_finish(ModuleWrapper& module);
+
+    /// Execute an instance of a module on a frame shared with an AsyncLane,
+    /// regardless of the schedule.  Run by the lane's threads.
+    /// \param[in] module The module.
+    /// \param[in] instance The module's own or a replica.
+    /// \param[in] conversions Provide the frame in the format required.
+    /// \param[out] result The result of the instance.
+    /// \return True if the result is to be published.
+    bool _module_run_async(ModuleWrapper& module, Module& instance,
+                           FrameConversions& conversions, Result& result);
+
+    /// Offer the current frame to the AsyncLane of each module which is
+    /// executed asynchronously and due, creating the lanes if necessary.
+    /// These modules are skipped by the mainloop afterwards.
+    /// \param[in] frame The current frame.
+    void _exec_async_lanes(FramePipeline::Frame const& frame);
+
+    /// Copy a frame to be shared by the async_lanes_.
+    /// \param[in] frame The current frame.
+    /// \return A frame from shared_frames_.
+    AsyncLane::SharedFrame _share_frame(FramePipeline::Frame const& frame);
+
+    /// Stop and remove AsyncLane's, which must be done before their module
+    /// is being removed.
+    /// \param[in] all If false, only those no longer enabled, asynchronous
+    /// or tagged Removable, and those not running the number of instances
+    /// requested.
+    void _stop_async_lanes(bool all);
+
+    /// Handle the runtime tags of a module after its execution.
+    /// \param[in] module The module.
+    void _module_handle_tags(ModuleWrapper& module);
+
+    /// Tag a module Removable and let the mainloop remove it.
+    /// \param[in] module The module.
+    void _module_removable(ModuleWrapper& module);
+
+    /// Execute a group of modules as provided by Modules::exec_grouped().
+    /// Only the last module of the group may output an image, so all of them
+    /// can be run concurrently on the worker_pool_ on the same frame.  Their
+    /// outputs are published in order afterwards.
+    /// \param[in] group Modules in order of execution.
+    void _module_exec_group(Modules::Group const& group);
+
     /// Threaded execution context of vision algorithms (modules).
     /// This method is started asynchronously during construction of
     /// the Api and is running until deconstruction.  It is constantly
-    /// grabbing frames from the active camera, executing all active
+    /// taking frames from the pipeline_, executing all active
     /// modules and activating newly registered modules.
     void execute(void);
 
-    int16_t _module_load(std::string const& name, int16_t id);
+    /// Capturing stage of the pipeline_, running concurrently to execute().
+    /// Applies pending camera changes and grabs the next frame at the
+    /// requested framerate.
+    /// \param[out] frame The next frame, referencing the camera buffer.
+    /// \return False if no frame was retrieved.
+    bool _capture_frame(Image& frame);
+
+    /// Pass a change of the camera settings to the mainloop and wait until
+    /// it has been applied.  If the mainloop is not running, change is
+    /// applied directly.
+    /// \param[in] change Applies the change, returning false if it failed.
+    /// \return
+    /// - #TV_CAMERA_SETTINGS_FAILED if change returned false.
+    /// - #TV_BUSY if the mainloop did not get to apply the change in time.
+    /// - #TV_OK else
+    int16_t _request_camera_change(std::function<bool(void)> change);
+
+    /// Apply a change requested by _request_camera_change(), if any.
+    /// This must only be called from the capturing stage, between two
+    /// frames.
+    void _apply_camera_request(void);
+
+    /// Load, initialize and insert a module.
+    /// \param[in] name Name of the library.
+    /// \param[in] id Id of the new module.
+    /// \param[in] wait If false, waiting for the insertion is given up after a
+    /// while, and the module is destroyed later.  Else, the insertion is
+    /// waited for as long as it takes and the module is enabled before
+    /// returning, as done by module_load_async().
+    /// \return #TV_BUSY if waiting was given up, else the outcome.
+    int16_t _module_load(std::string const& name, int16_t id,
+                         bool wait = false);
+
+    /// Fill a description from a parameter, with its current value.
+    static void _describe_parameter(Parameter const& parameter,
+                                    TV_ParameterDescription& description);
+
+    /// Wait until the threads started by module_load_async() are done.
+    void _wait_for_loads(void);
 
     void _disable_all_modules(void);
 
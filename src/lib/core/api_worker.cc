@@ -0,0 +1,141 @@
+/// \file api_worker.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Implementation of class ApiWorker.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "api_worker.hh"
+
+#include <algorithm>
+
+#include "thread_placement.hh"
+#include "time_source.hh"
+
+constexpr size_t tv::ApiWorker::max_buffered_;
+
+tv::ApiWorker::ApiWorker(void) {
+    worker_ = std::thread(&ApiWorker::_work, this);
+}
+
+tv::ApiWorker::~ApiWorker(void) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    requested_.notify_all();
+
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool tv::ApiWorker::call(Call call, Clock::duration timeout, Ticket& ticket,
+                         int16_t& result) {
+    auto& time = TimeSource::instance();
+    auto const deadline = time.now() + timeout;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // 0 is never handed out, tickets are unique among the ones kept
+    do {
+        ticket = ++next_ticket_;
+    } while (ticket == 0 or outcomes_.count(ticket));
+
+    auto& outcome = outcomes_[ticket];  // map nodes are stable
+    requests_.push_back({ticket, call});
+    requested_.notify_one();
+
+    if (time.wait_until(lock, completed_, deadline,
+                        [&outcome](void) { return outcome.done; })) {
+        result = outcome.result;
+        outcomes_.erase(ticket);
+        return true;
+    }
+
+    // kept for result(), the oldest are forgotten
+    buffered_.push_back(ticket);
+    if (buffered_.size() > max_buffered_) {
+        outcomes_.erase(buffered_.front());
+        buffered_.pop_front();
+    }
+    return false;
+}
+
+bool tv::ApiWorker::result(Ticket ticket, bool& done, int16_t& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // requests still waited for in call() are not known here
+    auto buffered = std::find(buffered_.begin(), buffered_.end(), ticket);
+    if (buffered == buffered_.end()) {
+        return false;
+    }
+
+    auto outcome = outcomes_.find(ticket);
+    done = outcome->second.done;
+    if (done) {
+        result = outcome->second.result;
+        outcomes_.erase(outcome);
+        buffered_.erase(buffered);
+    }
+    return true;
+}
+
+void tv::ApiWorker::drain(void) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    completed_.wait(lock,
+                    [this](void) { return requests_.empty() and not busy_; });
+}
+
+void tv::ApiWorker::_work(void) {
+    ThreadPlacement::Scope placement("api");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        requested_.wait(lock, [this](void) {
+            return stopped_ or not requests_.empty();
+        });
+        if (stopped_) {
+            break;
+        }
+
+        auto request = std::move(requests_.front());
+        requests_.pop_front();
+        busy_ = true;
+        lock.unlock();
+
+        auto const result = request.call();
+
+        lock.lock();
+        busy_ = false;
+
+        // might have been forgotten meanwhile
+        auto outcome = outcomes_.find(request.ticket);
+        if (outcome != outcomes_.end()) {
+            outcome->second.done = true;
+            outcome->second.result = result;
+        }
+        completed_.notify_all();
+    }
+}
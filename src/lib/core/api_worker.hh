@@ -0,0 +1,117 @@
+/// \file api_worker.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of class ApiWorker.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef API_WORKER_H
+#define API_WORKER_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "image.hh"
+
+namespace tv {
+
+/// Executes the calls of the C interface which may take long on a thread of
+/// its own, one after the other, so that the calling thread can return after
+/// a timeout.  Each request gets a ticket under which its result is kept
+/// once the caller stopped waiting for it, so that callers can retrieve the
+/// results of their own requests.
+class ApiWorker {
+public:
+    using Call = std::function<int16_t(void)>;
+    using Ticket = uint16_t;
+
+private:
+    /// A call waiting to be executed.
+    struct Request {
+        Ticket ticket;
+        Call call;
+    };
+
+    /// State of a request not yet collected.
+    struct Outcome {
+        bool done{false};
+        int16_t result{0};
+    };
+
+    static constexpr size_t max_buffered_ = 32;
+
+    std::deque<Request> requests_;        ///< Waiting, in order
+    std::map<Ticket, Outcome> outcomes_;  ///< Of the requests not collected
+    std::deque<Ticket> buffered_;         ///< Timed out, oldest first
+    Ticket next_ticket_{0};
+    bool busy_{false};  ///< A call is being executed
+    bool stopped_{false};
+
+    std::mutex mutex_;
+    std::condition_variable requested_;  ///< Signals requests_ and stopped_
+    std::condition_variable completed_;  ///< Signals outcomes_ and busy_
+    std::thread worker_;
+
+    /// The worker thread.
+    void _work(void);
+
+public:
+    /// Start the worker thread.
+    ApiWorker(void);
+
+    /// Stop the worker thread after the call being executed, if any.
+    /// Requests not yet executed are discarded.
+    ~ApiWorker(void);
+
+    ApiWorker(ApiWorker const&) = delete;
+    ApiWorker& operator=(ApiWorker const&) = delete;
+
+    /// Queue a call and wait for its execution.
+    /// \param[in] call The call, which must not refer to the stack of the
+    /// caller, since it may be executed after the timeout.
+    /// \param[in] timeout How long to wait.
+    /// \param[out] ticket Identifies the request, see result().
+    /// \param[out] result The result of the call, if it completed in time.
+    /// \return False if the timeout expired.  The result is kept then.
+    bool call(Call call, Clock::duration timeout, Ticket& ticket,
+              int16_t& result);
+
+    /// Retrieve the result of a request which timed out.  Only the latest
+    /// results are kept, and each only until it has been retrieved.
+    /// \param[in] ticket As returned by call().
+    /// \param[out] done False if the call has not completed yet.
+    /// \param[out] result The result of the call, if done.
+    /// \return False if the ticket is unknown.
+    bool result(Ticket ticket, bool& done, int16_t& result);
+
+    /// Wait until all requests queued have been executed.
+    void drain(void);
+};
+}
+
+#endif
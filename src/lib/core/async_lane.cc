@@ -0,0 +1,149 @@
+/// \file async_lane.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Implementation of class AsyncLane.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "async_lane.hh"
+
+#include "logger.hh"
+#include "thread_placement.hh"
+
+tv::AsyncLane::AsyncLane(ModuleWrapper& module, size_t workers,
+                         Executor executor)
+    : module_(module), executor_(executor), workers_(workers) {
+
+    instances_.push_back(module.executable());
+    while (instances_.size() < workers_) {
+        auto replica = module.replicate();
+        if (not replica) {
+            LogWarning("ASYNCLANE", "Executing ", module.name(), " on ",
+                       instances_.size(), " frames at once only");
+            break;
+        }
+        instances_.push_back(replica);
+    }
+
+    module.execute_on_lane(true);
+    for (size_t i = 0; i < instances_.size(); ++i) {
+        threads_.emplace_back(&AsyncLane::_execute, this, i);
+    }
+}
+
+tv::AsyncLane::~AsyncLane(void) { stop(); }
+
+bool tv::AsyncLane::idle(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return busy_ < threads_.size() and not frame_;
+}
+
+void tv::AsyncLane::offer(SharedFrame frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frame_ = frame;
+    }
+    frame_offered_.notify_one();
+}
+
+void tv::AsyncLane::stop(void) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        frame_.reset();
+    }
+    frame_offered_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    module_.execute_on_lane(false);
+
+    // the first instance is the module's own
+    for (size_t i = 1; i < instances_.size(); ++i) {
+        module_.destroy_replica(instances_[i]);
+    }
+    instances_.resize(1);
+}
+
+void tv::AsyncLane::_execute(size_t index) {
+    Log("ASYNCLANE", "Started for ", module_.name(), " (", module_.id(), ") ",
+        index);
+    ThreadPlacement::Scope placement("async");
+
+    auto& instance = *instances_[index];
+    uint32_t version = 0;
+    Result result;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        frame_offered_.wait(lock,
+                            [this](void) { return stopped_ or frame_; });
+        if (stopped_) {
+            break;
+        }
+
+        auto frame = std::move(frame_);
+        frame_.reset();
+        auto const number = taken_++;
+        busy_++;
+        lock.unlock();
+
+        if (index) {  // replicas follow parameter changes
+            module_.update_replica(instance, version);
+        }
+
+        auto const valid =
+            executor_(module_, instance, frame->conversions, result);
+        auto const timestamp = frame->image().header.timestamp;
+        frame.reset();  // the last lane using it releases it here
+
+        _complete(number, {valid, result, timestamp});
+
+        lock.lock();
+        busy_--;
+    }
+
+    Log("ASYNCLANE", "Stopped for ", module_.name(), " (", module_.id(), ") ",
+        index);
+}
+
+void tv::AsyncLane::_complete(uint64_t number, Completed const& completed) {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+
+    completed_.emplace(number, completed);
+
+    // frames completed in order are published at once
+    for (auto it = completed_.begin();
+         it != completed_.end() and it->first == published_;
+         it = completed_.erase(it)) {
+
+        if (it->second.valid) {
+            module_.publish(it->second.result, it->second.timestamp);
+        }
+        published_++;
+    }
+}
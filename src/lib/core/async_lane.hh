@@ -0,0 +1,132 @@
+/// \file async_lane.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of class AsyncLane.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef ASYNC_LANE_H
+#define ASYNC_LANE_H
+
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <map>
+
+#include "frame_pipeline.hh"
+#include "module_wrapper.hh"
+
+namespace tv {
+
+/// Executes a single, slow module on its own thread, so that it does not hold
+/// up the mainloop.  The mainloop offer()'s a frame whenever the lane is
+/// idle, which is then the latest frame available.  The frame is shared
+/// with other lanes and released once the last of them is done with it.
+///
+/// A stateless module can be executed on several consecutive frames at once,
+/// each by another instance on its own thread, see ModuleWrapper::parallel().
+/// The results are then publish()'ed in the order of the frames.
+class AsyncLane {
+public:
+    using SharedFrame = std::shared_ptr<FramePipeline::Frame>;
+
+    /// Executes an instance of the module on a frame.  Returns true if the
+    /// result is to be published.
+    using Executor = std::function<bool(ModuleWrapper&, Module& instance,
+                                        FrameConversions&, Result& result)>;
+
+private:
+    ModuleWrapper& module_;
+    Executor executor_;
+    size_t const workers_;  ///< Requested number of instances
+
+    std::vector<Module*> instances_;  ///< The module's own, then replicas
+    std::vector<std::thread> threads_;  ///< One per instance
+
+    SharedFrame frame_;    ///< Offered, not yet taken by a thread
+    size_t busy_{0};       ///< Threads executing the module
+    uint64_t taken_{0};    ///< Frames taken, numbering them
+    bool stopped_{false};
+
+    std::mutex mutex_;
+    std::condition_variable frame_offered_;
+
+    /// A frame executed, waiting for the preceding frames.
+    struct Completed {
+        bool valid;           ///< False if there is no result to publish
+        Result result;
+        Timestamp timestamp;  ///< Of the frame
+    };
+
+    /// Frames completed out of order, by number.
+    std::map<uint64_t, Completed> completed_;
+    uint64_t published_{0};  ///< Number of the next frame to be published
+    std::mutex publish_mutex_;
+
+    /// Thread executing an instance of the module on each offered frame.
+    /// \param[in] index Index into instances_.
+    void _execute(size_t index);
+
+    /// Publish the result of a frame and those completed before, as soon as
+    /// all preceding frames are done.
+    /// \param[in] number Number of the frame.
+    /// \param[in] completed The result.
+    void _complete(uint64_t number, Completed const& completed);
+
+public:
+    /// Start the threads.
+    /// \param[in] module The module to be executed, which must not be
+    /// removed before stop() returned.
+    /// \param[in] workers Number of frames to execute at once, by as many
+    /// instances of the module.  If more than one, the module has to be
+    /// stateless.
+    /// \param[in] executor Called for each frame.
+    AsyncLane(ModuleWrapper& module, size_t workers, Executor executor);
+
+    /// Calls stop().
+    ~AsyncLane(void);
+
+    AsyncLane(AsyncLane const&) = delete;
+    AsyncLane& operator=(AsyncLane const&) = delete;
+
+    /// Check whether the lane waits for a frame.
+    /// \return True if an instance is idle and no frame is pending.
+    bool idle(void);
+
+    /// Get the number of instances requested during construction.
+    /// \return workers_.
+    size_t workers(void) const { return workers_; }
+
+    /// Pass a frame to be processed next, replacing one not yet taken.
+    /// \param[in] frame The frame.
+    void offer(SharedFrame frame);
+
+    /// Stop the threads, waiting for running executions to finish, and
+    /// destroy the replicas.
+    void stop(void);
+};
+}
+#endif
@@ -0,0 +1,188 @@
+/// \file callback_dispatcher.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Implementation of class CallbackDispatcher.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "callback_dispatcher.hh"
+
+#include "logger.hh"
+#include "thread_placement.hh"
+
+constexpr size_t tv::CallbackDispatcher::capacity_;
+
+tv::CallbackDispatcher::CallbackDispatcher(void)
+    : head_(&stub_), tail_(&stub_) {
+
+    dispatcher_ = std::thread(&CallbackDispatcher::_dispatch, this);
+}
+
+tv::CallbackDispatcher::~CallbackDispatcher(void) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    posted_.notify_one();
+
+    if (dispatcher_.joinable()) {
+        dispatcher_.join();
+    }
+
+    Log("DISPATCHER", "Stopped, ", dropped_, " results dropped");
+}
+
+bool tv::CallbackDispatcher::post(std::shared_ptr<Channel> const& channel,
+                                  TV_Callback callback, int8_t module_id,
+                                  TV_ModuleResult const& result) {
+    if (not _reserve()) {
+        return false;
+    }
+
+    auto delivery = new Delivery;
+    delivery->callback = callback;
+    delivery->module_id = module_id;
+    delivery->result = result;
+    delivery->channel = channel;
+    delivery->sequence = ++channel->posted;
+
+    _push(delivery);
+    return true;
+}
+
+bool tv::CallbackDispatcher::post(TV_FrameCallback callback,
+                                  std::vector<TV_FrameResult> const& results,
+                                  void* context) {
+    if (not _reserve()) {
+        return false;
+    }
+
+    auto delivery = new Delivery;
+    delivery->frame_callback = callback;
+    delivery->frame = results;
+    delivery->context = context;
+
+    _push(delivery);
+    return true;
+}
+
+bool tv::CallbackDispatcher::_reserve(void) {
+    if (size_.fetch_add(1) >= capacity_) {
+        size_--;
+        dropped_++;
+        return false;
+    }
+    return true;
+}
+
+void tv::CallbackDispatcher::_push(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    auto previous = head_.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+
+    // see _dispatch(): either the consumer sees the size, or this sees it
+    // sleeping
+    if (node != &stub_ and sleeping_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        posted_.notify_one();
+    }
+}
+
+tv::CallbackDispatcher::Node* tv::CallbackDispatcher::_pop(void) {
+    auto tail = tail_;
+    auto next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &stub_) {  // skip the stub
+        if (not next) {
+            return nullptr;
+        }
+        tail_ = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next) {
+        tail_ = next;
+        return tail;
+    }
+
+    // tail is the last node, unless a producer has not linked it yet
+    if (tail != head_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    // the stub is appended so that tail can be taken
+    _push(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+        tail_ = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+void tv::CallbackDispatcher::_dispatch(void) {
+    ThreadPlacement::Scope placement("callbacks");
+
+    while (true) {
+        auto node = _pop();
+
+        if (not node) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleeping_ = true;
+            posted_.wait(lock,
+                         [this](void) { return stopped_ or size_ > 0; });
+            sleeping_ = false;
+
+            if (stopped_) {
+                break;
+            }
+            continue;
+        }
+
+        size_--;
+        auto delivery = static_cast<Delivery*>(node);
+
+        auto const& channel = delivery->channel;
+        if (delivery->frame_callback) {
+            delivery->frame_callback(
+                delivery->frame.data(),
+                static_cast<uint16_t>(delivery->frame.size()),
+                delivery->context);
+
+        } else if (channel->coalesce and
+                   delivery->sequence != channel->posted) {
+            dropped_++;  // superseded by a result still queued
+
+        } else {
+            delivery->callback(delivery->module_id, delivery->result,
+                               nullptr);
+        }
+
+        delete delivery;
+    }
+
+    while (auto node = _pop()) {
+        delete static_cast<Delivery*>(node);
+    }
+}
@@ -0,0 +1,144 @@
+/// \file callback_dispatcher.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of class CallbackDispatcher.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef CALLBACK_DISPATCHER_H
+#define CALLBACK_DISPATCHER_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "tinkervision_defines.h"
+
+namespace tv {
+
+/// Delivers the results of modules to the user's callbacks from a thread of
+/// its own, so that slow callbacks don't stall the execution of modules.
+/// Results are posted to a lock-free queue with many producers, i.e. the
+/// threads executing modules, and one consumer, the dispatching thread.  The
+/// queue is bounded; results posted to a full queue are dropped.
+///
+/// Each module posts through its own Channel.  If the channel coalesces, only
+/// the latest result posted is delivered: results superseded while waiting
+/// in the queue are dropped.  All drops are counted.  The results of a frame
+/// can also be posted at once, to a TV_FrameCallback.
+class CallbackDispatcher {
+public:
+    /// Per-module state, shared with the results in the queue so that a
+    /// module can be removed while its results are still queued.
+    struct Channel {
+        std::atomic<uint64_t> posted{0};   ///< Sequence of the latest result
+        std::atomic<bool> coalesce{true};  ///< Deliver the latest only?
+    };
+
+private:
+    /// Node of the intrusive queue.
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+    };
+
+    /// A result, or the results of a frame, waiting to be delivered.
+    struct Delivery : Node {
+        TV_Callback callback{nullptr};
+        int8_t module_id;
+        TV_ModuleResult result;
+        std::shared_ptr<Channel> channel;  ///< nullptr for frames
+        uint64_t sequence;
+
+        TV_FrameCallback frame_callback{nullptr};
+        std::vector<TV_FrameResult> frame;
+        void* context;
+    };
+
+    static constexpr size_t capacity_ = 256;
+
+    std::atomic<Node*> head_;  ///< Pushed to by the producers
+    Node* tail_;               ///< Popped from by the consumer
+    Node stub_;                ///< Keeps the queue non-empty
+
+    std::atomic<size_t> size_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::atomic<bool> sleeping_{false};  ///< Consumer waits for a post()
+    bool stopped_{false};
+    std::mutex mutex_;  ///< Only taken to sleep and wake up
+    std::condition_variable posted_;
+    std::thread dispatcher_;
+
+    /// Reserve a place in the queue.
+    /// \return False if it is full, counting a drop.
+    bool _reserve(void);
+
+    /// Append to the queue, wait-free, and wake the consumer if needed.
+    void _push(Node* node);
+
+    /// Take the oldest node from the queue.
+    /// \return nullptr if the queue is empty, or a producer is just pushing.
+    Node* _pop(void);
+
+    /// The dispatching thread.
+    void _dispatch(void);
+
+public:
+    /// Start the dispatching thread.
+    CallbackDispatcher(void);
+
+    /// Stop the dispatching thread, dropping the results not yet delivered.
+    ~CallbackDispatcher(void);
+
+    CallbackDispatcher(CallbackDispatcher const&) = delete;
+    CallbackDispatcher& operator=(CallbackDispatcher const&) = delete;
+
+    /// Queue a result for delivery.  Can be called concurrently.
+    /// \param[in] channel Channel of the module.
+    /// \param[in] callback The callback to be called.
+    /// \param[in] module_id Passed to the callback.
+    /// \param[in] result Passed to the callback.
+    /// \return False if the queue is full and the result has been dropped.
+    bool post(std::shared_ptr<Channel> const& channel, TV_Callback callback,
+              int8_t module_id, TV_ModuleResult const& result);
+
+    /// Queue the results of a frame for delivery at once.  These are never
+    /// coalesced.  Can be called concurrently.
+    /// \param[in] callback The callback to be called.
+    /// \param[in] results Passed to the callback.
+    /// \param[in] context Passed to the callback.
+    /// \return False if the queue is full and the results have been dropped.
+    bool post(TV_FrameCallback callback,
+              std::vector<TV_FrameResult> const& results, void* context);
+
+    /// Get the number of results not delivered, because the queue was full
+    /// or they were coalesced.
+    /// \return dropped_.
+    uint64_t dropped(void) const { return dropped_; }
+};
+}
+
+#endif
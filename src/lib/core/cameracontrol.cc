@@ -27,6 +27,7 @@
 #include <thread>
 #include <chrono>
 #include <fstream>
+#include <algorithm>
 
 #include "cameracontrol.hh"
 #include "logger.hh"
@@ -37,6 +38,7 @@
 #endif
 
 #include "filesystem.hh"
+#include "time_source.hh"
 
 tv::CameraControl::~CameraControl(void) { release_all(); }
 
@@ -130,9 +132,14 @@ bool tv::CameraControl::preselect_framesize(uint16_t framewidth,
             size_t bytesize;
             camera_->get_properties(width, height, bytesize);
 
+            auto const scale = camera_->decode_scale();
+            auto const cropped = camera_->region_applied();
             stop_camera();
 
-            if ((width != framewidth) or (height != frameheight)) {
+            // If the device crops, the framesize is that of the region.
+            if (not cropped and
+                ((width != (framewidth + scale - 1) / scale) or
+                 (height != (frameheight + scale - 1) / scale))) {
                 requested_width_ = old_width;
                 requested_height_ = old_height;
                 return false;
@@ -142,6 +149,94 @@ bool tv::CameraControl::preselect_framesize(uint16_t framewidth,
     return true;
 }
 
+bool tv::CameraControl::switch_framesize(uint16_t framewidth,
+                                         uint16_t frameheight) {
+    if (not is_open()) {
+        return preselect_framesize(framewidth, frameheight);
+    }
+
+    if (framewidth == requested_width_ and frameheight == requested_height_) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> cam_mutex(camera_mutex_);
+
+    auto old_width = requested_width_;
+    auto old_height = requested_height_;
+
+    requested_width_ = framewidth;
+    requested_height_ = frameheight;
+
+    if (_reopen()) {
+        Log("CAMERA_CONTROL", "Switched framesize to ", framewidth, "x",
+            frameheight);
+        return true;
+    }
+
+    LogWarning("CAMERA_CONTROL", "Framesize ", framewidth, "x", frameheight,
+               " not available");
+
+    requested_width_ = old_width;
+    requested_height_ = old_height;
+    if (not _reopen()) {
+        LogError("CAMERA_CONTROL", "Could not restore the last framesize");
+    }
+    return false;
+}
+
+bool tv::CameraControl::preselect_region(FrameRegion const& region) {
+    if (is_open()) {
+        return false;
+    }
+
+    // Checked against the framesize when the camera is opened.
+    requested_region_ = region;
+    return true;
+}
+
+bool tv::CameraControl::switch_region(FrameRegion const& region) {
+    if (not is_open()) {
+        return preselect_region(region);
+    }
+
+    std::lock_guard<std::mutex> cam_mutex(camera_mutex_);
+
+    auto old_region = requested_region_;
+    requested_region_ = region;
+
+    auto applied = [this](void) {
+        return not requested_region_ or camera_->region_applied() or crop_;
+    };
+
+    if (_reopen() and applied()) {
+        Log("CAMERA_CONTROL", "Switched region to ", region.width, "x",
+            region.height, " at ", region.x, ",", region.y);
+        return true;
+    }
+
+    LogWarning("CAMERA_CONTROL", "Region ", region.width, "x", region.height,
+               " at ", region.x, ",", region.y, " not available");
+
+    requested_region_ = old_region;
+    if (not _reopen()) {
+        LogError("CAMERA_CONTROL", "Could not restore the last region");
+    }
+    return false;
+}
+
+bool tv::CameraControl::preselect_decode_scale(uint8_t scale) {
+    if (is_open()) {
+        return false;
+    }
+
+    if (scale != 1 and scale != 2 and scale != 4 and scale != 8) {
+        return false;
+    }
+
+    requested_decode_scale_ = scale;
+    return true;
+}
+
 bool tv::CameraControl::acquire(size_t user) {
     auto result = false;
 
@@ -156,6 +251,8 @@ bool tv::CameraControl::acquire(size_t user) {
 }
 
 bool tv::CameraControl::acquire(void) {
+    // modules are loaded and released from several threads
+    std::lock_guard<std::mutex> users_lock(users_mutex_);
     std::lock_guard<std::mutex> cam_mutex(camera_mutex_);
 
     auto open = is_open();
@@ -163,7 +260,7 @@ bool tv::CameraControl::acquire(void) {
     if (not open) {
 
         if (camera_) {
-            release();
+            _close_device(&camera_);
         }
 
         // on first open, get a frame to learn the header.
@@ -198,6 +295,7 @@ int16_t tv::CameraControl::current_device(void) const {
 }
 
 void tv::CameraControl::release(void) {
+    std::lock_guard<std::mutex> users_lock(users_mutex_);
 
     usercount_ = std::max(usercount_ - 1, 0);
 
@@ -223,9 +321,16 @@ void tv::CameraControl::release_all(void) {
     _close_device(&camera_);
 }
 
-bool tv::CameraControl::get_properties(uint16_t& height, uint16_t& width,
+bool tv::CameraControl::get_properties(uint16_t& width, uint16_t& height,
                                        size_t& frame_bytesize) {
-    return is_open() and camera_->get_properties(height, width, frame_bytesize);
+    if (is_open() and crop_) {
+        auto const& header = image_().header;
+        width = header.width;
+        height = header.height;
+        frame_bytesize = header.bytesize;
+        return true;
+    }
+    return is_open() and camera_->get_properties(width, height, frame_bytesize);
 }
 
 bool tv::CameraControl::get_resolution(uint16_t& width, uint16_t& height) {
@@ -267,10 +372,28 @@ bool tv::CameraControl::_update_from_camera(void) {
         if (not camera_ or not camera_->get_frame(image)) {
             return false;
         }
-        image_.copy_data(image.data, image.header.bytesize);
+
+        if (not crop_) {
+            image_.copy_data(image.data, image.header.bytesize);
+
+        } else {
+            // Copying only the rows and columns of the region, which are
+            // packed in image_.
+            auto const stride = image.header.bytesize / image.header.height;
+            auto const bytes = image_().header.bytesize / crop_.height;
+            auto const offset = bytes / crop_.width * crop_.x;
+
+            auto from = image.data + stride * crop_.y + offset;
+            auto to = image_.image().data;
+            for (size_t row = 0; row < crop_.height; ++row) {
+                std::copy_n(from, bytes, to);
+                from += stride;
+                to += bytes;
+            }
+        }
     }
 
-    image_.image().header.timestamp = Clock::now();
+    image_.image().header.timestamp = TimeSource::instance().now();
     return true;
 }
 
@@ -314,12 +437,64 @@ bool tv::CameraControl::_init(void) {
         success = _open_device(&camera_);
     }
     if (success) {
-        image_.allocate(camera_->frame_header(), false);
+        auto header = camera_->frame_header();
+        _select_crop(header);
+        image_.allocate(header, false);
     }
 
     return success;
 }
 
+bool tv::CameraControl::_reopen(void) {
+    // The device has to be closed to change the buffers, but the users are
+    // kept. _init() reallocates image_.
+    _close_device(&camera_);
+    return _init();
+}
+
+void tv::CameraControl::_select_crop(ImageHeader& header) {
+    crop_ = FrameRegion();
+
+    if (not requested_region_ or camera_->region_applied()) {
+        return;
+    }
+
+    // Only packed formats can be cut out row by row.
+    auto bytes_per_pixel = size_t(0);
+    auto alignment = uint16_t(1);
+    switch (header.format) {
+        case ColorSpace::YUYV:
+            bytes_per_pixel = 2;
+            alignment = 2;  // U and V are shared by two pixels
+            break;
+        case ColorSpace::BGR888:
+        case ColorSpace::RGB888:
+            bytes_per_pixel = 3;
+            break;
+        case ColorSpace::GRAY:
+            bytes_per_pixel = 1;
+            break;
+        default:
+            break;
+    }
+
+    auto region = requested_region_;
+    region.x -= region.x % alignment;
+    region.width -= region.width % alignment;
+
+    if (not bytes_per_pixel or not region or
+        region.x + region.width > header.width or
+        region.y + region.height > header.height) {
+        LogWarning("CAMERA_CONTROL", "Region ignored for frames ", header);
+        return;
+    }
+
+    crop_ = region;
+    header.width = region.width;
+    header.height = region.height;
+    header.bytesize = bytes_per_pixel * region.width * region.height;
+}
+
 bool tv::CameraControl::_open_device(Camera** device) {
     static const auto MAX_DEVICE = 5;
     auto i = uint8_t(MAX_DEVICE);
@@ -335,8 +510,9 @@ bool tv::CameraControl::_open_device(Camera** device) {
             *device = new OpenCvUSBCamera(i);
 #else
             Log("CAMERACONTROL", "Opening V4L2 camera device ", i);
-            *device = new V4L2USBCamera(i);
+            *device = new V4L2USBCamera(i, requested_decode_scale_);
 #endif
+            (*device)->select_region(requested_region_);
 
             if ((*device)->open(requested_width_, requested_height_)) {
                 stopped_ = false;
@@ -362,8 +538,9 @@ bool tv::CameraControl::_open_device(Camera** device, uint8_t id) {
     *device = new OpenCvUSBCamera(id);
 #else
     Log("CAMERACONTROL", "Opening V4L2 camera device ", id);
-    *device = new V4L2USBCamera(id);
+    *device = new V4L2USBCamera(id, requested_decode_scale_);
 #endif
+    (*device)->select_region(requested_region_);
     if (not(*device)->open(requested_width_, requested_height_)) {
         delete *device;
         (*device) = nullptr;
@@ -30,6 +30,7 @@
 #include <sys/stat.h>  // stat, for _device_exists()
 #include <string>
 #include <mutex>
+#include <atomic>
 
 #include "image.hh"
 #include "convert.hh"
@@ -76,6 +77,47 @@ public:
     /// \param[in] framheight Height requested
     bool preselect_framesize(uint16_t framewidth, uint16_t frameheight);
 
+    /// Change the framesize of an active camera.  The device is reopened
+    /// with the new settings and the frame buffer reallocated, while the
+    /// usercount is preserved.  Since this invalidates the frame returned by
+    /// the last update_frame(), it must only be called between two frames,
+    /// i.e. from the context calling update_frame().  If the camera is not
+    /// active, this equals preselect_framesize().
+    /// \param[in] framewidth Width requested
+    /// \param[in] frameheight Height requested
+    /// \return False if the framesize is not available.  The last settings
+    /// are restored then.
+    bool switch_framesize(uint16_t framewidth, uint16_t frameheight);
+
+    /// Request a region of the frames to be captured when initializing the
+    /// camera. Frames handed out by update_frame() will then only contain
+    /// this region.  If the device supports it, the device crops the frames,
+    /// else the region is cut out while copying the frames from the device.
+    /// This will only work if the camera is not active.
+    /// \param[in] region Region in pixels of the frames delivered by the
+    /// camera, or an empty region to use the full frames.
+    /// \return False if the camera is active.
+    bool preselect_region(FrameRegion const& region);
+
+    /// Change the region of an active camera, see switch_framesize().  If the
+    /// camera is not active, this equals preselect_region().
+    /// \param[in] region Region requested, or an empty region.
+    /// \return False if the region does not fit into the frames.  The last
+    /// settings are restored then.
+    bool switch_region(FrameRegion const& region);
+
+    /// Get the region the frames are cropped to.
+    /// \return The selected region, which is empty if none is selected.
+    FrameRegion const& region(void) const { return requested_region_; }
+
+    /// Request a scale to be applied when decoding compressed frames.  The
+    /// framesize of the frames handed out will be the selected framesize
+    /// divided by scale. Has no effect on uncompressed frames.
+    /// This will only work if the camera is not active.
+    /// \param[in] scale Denominator of the scale, one of 1, 2, 4, 8.
+    /// \return False if the camera is active or scale is not supported.
+    bool preselect_decode_scale(uint8_t scale);
+
     /// Check if (any) cameradevice is available, acquire it if necessary.
     /// If no device is open already, seeks for a possible device, opens it,
     /// increases the usercount.  No effects on visible state if opening fails.
@@ -122,12 +164,13 @@ public:
     void release_all(void);
 
     /// Retrieves the frame properties from an opened device. No effect on
-    /// visible state.
-    /// \param[out] height (visible) image height, i.e. in pixel
+    /// visible state.  If a region is selected, these are the properties of
+    /// the region.
     /// \param[out] width (visible) image width, i.e. in pixel
+    /// \param[out] height (visible) image height, i.e. in pixel
     /// \param[out] bytesize total image width, i.e. in byte
     /// \return False if no camera is opened or retrieving the values fails.
-    bool get_properties(uint16_t& height, uint16_t& width, size_t& bytesize);
+    bool get_properties(uint16_t& width, uint16_t& height, size_t& bytesize);
 
     /// Retrieves the frame properties from an opened device. No effect on
     /// visible state.
@@ -158,15 +201,19 @@ private:
     Camera* camera_{nullptr};
     size_t requested_width_{640};
     size_t requested_height_{480};
+    uint8_t requested_decode_scale_{1};
+    FrameRegion requested_region_{};
+    FrameRegion crop_{};  ///< Region cut out from the frames if not empty
 
     int16_t preferred_device_{-1};  ///< If any device id is preferred, >= 0.
 
     ImageAllocator fallback_{"CC/Fallback"};  ///< Black frame
     ImageAllocator image_{"CC/Image"};        ///< Data exchanged with the Api
 
-    int usercount_ = 0;
+    std::atomic<int> usercount_{0};
     bool stopped_ = false;
 
+    std::mutex users_mutex_;   ///< Serializes acquire() and release()
     std::mutex camera_mutex_;  //< This locks access to the private methods
 
     /// Open a device.
@@ -180,6 +227,8 @@ private:
     bool _test_device(void);
     bool _test_device(Camera** cam, uint8_t device);
     bool _init(void);
+    bool _reopen(void);
+    void _select_crop(ImageHeader& header);
     bool _update_from_camera(void);
     bool _update_from_fallback(void);
 };
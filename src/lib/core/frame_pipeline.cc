@@ -0,0 +1,232 @@
+/// \file frame_pipeline.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Implementation of class FramePipeline.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "frame_pipeline.hh"
+
+#include "logger.hh"
+#include "thread_placement.hh"
+
+constexpr size_t tv::FramePipeline::queue_capacity_;
+constexpr size_t tv::FramePipeline::frame_count_;
+
+tv::FramePipeline::Frame* tv::FramePipeline::Queue::push(Frame* frame) {
+    Frame* dropped = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (frames_.size() == capacity_) {
+            dropped = frames_.front();
+            frames_.pop_front();
+        }
+        frames_.push_back(frame);
+    }
+    available_.notify_one();
+
+    return dropped;
+}
+
+tv::FramePipeline::Frame* tv::FramePipeline::Queue::pop(void) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    available_.wait(lock, [this](void) {
+        return closed_ or woken_ or not frames_.empty();
+    });
+
+    if (closed_ or woken_) {
+        woken_ = false;
+        return nullptr;
+    }
+
+    auto frame = frames_.front();
+    frames_.pop_front();
+    return frame;
+}
+
+void tv::FramePipeline::Queue::close(void) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    available_.notify_all();
+}
+
+void tv::FramePipeline::Queue::wake(void) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        woken_ = true;
+    }
+    available_.notify_all();
+}
+
+void tv::FramePipeline::Queue::open(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = false;
+    woken_ = false;
+}
+
+void tv::FramePipeline::Queue::drain(std::vector<Frame*>& frames) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frames.insert(frames.end(), frames_.cbegin(), frames_.cend());
+    frames_.clear();
+}
+
+tv::FramePipeline::FramePipeline(Capture capture) : capture_(capture) {
+    for (size_t i = 0; i < frame_count_; ++i) {
+        frames_.emplace_back(new Frame);
+        free_.push_back(frames_.back().get());
+    }
+}
+
+tv::FramePipeline::~FramePipeline(void) { stop(); }
+
+bool tv::FramePipeline::start(void) {
+    if (running_) {
+        return true;
+    }
+
+    captured_.open();
+    converted_.open();
+    running_ = true;
+
+    capturer_ = std::thread(&FramePipeline::_capture, this);
+    converter_ = std::thread(&FramePipeline::_convert, this);
+
+    if (not capturer_.joinable() or not converter_.joinable()) {
+        LogError("PIPELINE", "Thread creation failed");
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void tv::FramePipeline::stop(void) {
+    running_ = false;
+    captured_.close();
+    converted_.close();
+
+    if (capturer_.joinable()) {
+        capturer_.join();
+    }
+    if (converter_.joinable()) {
+        converter_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(free_mutex_);
+    captured_.drain(free_);
+    converted_.drain(free_);
+}
+
+tv::FramePipeline::Frame* tv::FramePipeline::next(void) {
+    return converted_.pop();
+}
+
+void tv::FramePipeline::release(Frame* frame) {
+    std::vector<ColorSpace> formats;
+    frame->conversions.requested_formats(formats);
+
+    // A frame without requests, i.e. if modules skipped it, keeps the
+    // formats in preparation.
+    if (not formats.empty()) {
+        std::lock_guard<std::mutex> lock(formats_mutex_);
+        formats_.swap(formats);
+    }
+
+    _recycle(frame);
+}
+
+void tv::FramePipeline::_capture(void) {
+    ThreadPlacement::Scope placement("capture");
+    Image image;
+
+    while (running_) {
+        if (not capture_(image)) {
+            continue;
+        }
+
+        auto frame = _acquire();
+        if (not frame) {  // should not happen, see frame_count_
+            dropped_++;
+            continue;
+        }
+
+        auto& buffer = frame->image;
+        if (buffer().header != image.header) {
+            buffer.allocate(image.header, false);
+        }
+        buffer.copy_data(image.data, image.header.bytesize);
+        buffer.image().header.timestamp = image.header.timestamp;
+
+        _pass(captured_, frame);
+    }
+}
+
+void tv::FramePipeline::_convert(void) {
+    ThreadPlacement::Scope placement("convert");
+    std::vector<ColorSpace> formats;
+
+    while (running_) {
+        auto frame = captured_.pop();
+        if (not frame) {
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(formats_mutex_);
+            formats = formats_;
+        }
+        frame->conversions.prepare(frame->image(), formats);
+
+        _pass(converted_, frame);
+    }
+}
+
+tv::FramePipeline::Frame* tv::FramePipeline::_acquire(void) {
+    std::lock_guard<std::mutex> lock(free_mutex_);
+
+    if (free_.empty()) {
+        return nullptr;
+    }
+
+    auto frame = free_.back();
+    free_.pop_back();
+    return frame;
+}
+
+void tv::FramePipeline::_recycle(Frame* frame) {
+    std::lock_guard<std::mutex> lock(free_mutex_);
+    free_.push_back(frame);
+}
+
+void tv::FramePipeline::_pass(Queue& queue, Frame* frame) {
+    auto dropped = queue.push(frame);
+
+    if (dropped) {
+        dropped_++;
+        LogDebug("PIPELINE", "Dropped frame ", dropped_);
+        _recycle(dropped);
+    }
+}
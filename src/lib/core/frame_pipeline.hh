@@ -0,0 +1,179 @@
+/// \file frame_pipeline.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of class FramePipeline.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "image.hh"
+#include "convert.hh"
+
+namespace tv {
+
+/// Provides camera frames to the mainloop in overlapping stages.  While the
+/// mainloop analyses frame N, frame N+1 is being converted and frame N+2 is
+/// being captured, each stage running on its own thread.  The stages are
+/// connected by queues of bounded length; if a stage is slower than the one
+/// before, the oldest waiting frame is dropped in favour of the newer one.
+/// The frames are taken from a fixed set of buffers, so no allocation happens
+/// after the first frames unless the framesize changes.
+class FramePipeline {
+public:
+    /// A frame together with its conversions into the formats requested by
+    /// the modules.
+    struct Frame {
+        ImageAllocator image{"Pipeline"};
+        FrameConversions conversions;
+    };
+
+    /// Retrieves the next frame from the camera. Returning false means that
+    /// no frame is available right now.
+    using Capture = std::function<bool(Image& frame)>;
+
+private:
+    /// Queue between two stages, keeping the newest frames only.
+    class Queue {
+    private:
+        std::deque<Frame*> frames_;
+        size_t const capacity_;
+        bool closed_{false};
+        bool woken_{false};
+
+        std::mutex mutex_;
+        std::condition_variable available_;
+
+    public:
+        explicit Queue(size_t capacity) : capacity_(capacity) {}
+
+        /// Append a frame.
+        /// \return The oldest frame, if it had to be removed to respect the
+        /// capacity, else nullptr.
+        Frame* push(Frame* frame);
+
+        /// Remove the oldest frame, waiting for one to become available.
+        /// \return nullptr if the queue has been closed or woken.
+        Frame* pop(void);
+
+        /// Let each pop() return immediately.
+        void close(void);
+
+        /// Let one waiting or the next pop() return without a frame.
+        void wake(void);
+
+        /// Allow pop() to wait again.
+        void open(void);
+
+        /// Remove all frames.
+        /// \param[out] frames The removed frames are appended.
+        void drain(std::vector<Frame*>& frames);
+    };
+
+    static constexpr size_t queue_capacity_ = 1;
+    /// capturing, converting, analysing plus the previously analysed frame
+    /// and the content of both queues
+    static constexpr size_t frame_count_ = 4 + 2 * queue_capacity_;
+
+    std::vector<std::unique_ptr<Frame>> frames_;  ///< Owned buffers
+    std::vector<Frame*> free_;                    ///< Buffers not in use
+    std::mutex free_mutex_;                       ///< Guards free_
+
+    Queue captured_{queue_capacity_};   ///< Capturing -> Converting
+    Queue converted_{queue_capacity_};  ///< Converting -> Analysing
+
+    std::vector<ColorSpace> formats_;  ///< Formats prepared by _convert()
+    std::mutex formats_mutex_;         ///< Guards formats_
+
+    Capture capture_;
+    std::thread capturer_;
+    std::thread converter_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> dropped_{0};
+
+    /// Capturing stage.
+    void _capture(void);
+
+    /// Converting stage.
+    void _convert(void);
+
+    /// Get a free buffer.
+    /// \return nullptr if none is left.
+    Frame* _acquire(void);
+
+    /// Return a buffer to the free ones.
+    void _recycle(Frame* frame);
+
+    /// Put a frame into a queue, recycling a frame dropped from it.
+    void _pass(Queue& queue, Frame* frame);
+
+public:
+    /// Construct the pipeline, not yet running.
+    /// \param[in] capture Called from the capturing stage for each frame.
+    explicit FramePipeline(Capture capture);
+
+    /// Stops the pipeline if running.
+    ~FramePipeline(void);
+
+    FramePipeline(FramePipeline const&) = delete;
+    FramePipeline& operator=(FramePipeline const&) = delete;
+
+    /// Start the capturing and converting stages.
+    /// \return False if the threads could not be started.
+    bool start(void);
+
+    /// Stop and join the capturing and converting stages.  Frames retrieved
+    /// with next() and not yet release()'d remain valid.
+    void stop(void);
+
+    /// Get the next frame for analysis, waiting until one arrives.  Each
+    /// frame retrieved has to be release()'d once it is not used anymore.
+    /// \return nullptr if the pipeline has been stopped or woken.
+    Frame* next(void);
+
+    /// Let a waiting or the next call of next() return without a frame, so
+    /// that the caller can handle other events.
+    void wake(void) { converted_.wake(); }
+
+    /// Hand a frame retrieved from next() back to the pipeline.  The formats
+    /// requested of its conversions will be prepared for the following
+    /// frames.
+    /// \param[in] frame A frame as returned by next().
+    void release(Frame* frame);
+
+    /// Get the number of frames dropped because a stage was busy.
+    /// \return dropped_.
+    uint64_t dropped(void) const { return dropped_; }
+};
+}
+#endif
@@ -65,7 +65,7 @@ std::ostream& tv::operator<<(std::ostream& os, tv::SceneTree const& tree) {
         }
     };
 
-    auto node = tree.root();
+    auto const& node = tree.root();
 
     os << "(";
     node_recursion(node, 0);
@@ -34,6 +34,8 @@
 #include "filesystem.hh"
 #include "logger.hh"
 
+thread_local int16_t tv::ModuleLoader::error_{TV_OK};
+
 tv::ModuleLoader::ModuleLoader(Environment const& environment)
     : environment_(environment),
       dirwatch_(&ModuleLoader::_watched_directory_changed_callback, this) {
@@ -153,35 +155,39 @@ bool tv::ModuleLoader::load_module_from_library(ModuleWrapper** target,
     }
 
     // prefer user modules
-    lib = _load_module_from_library(target, environment_.user_modules_path(),
-                                    libname, id);
-    if (lib != nullptr) {
-        handles_[*target] = {libname, environment_.user_modules_path(), lib};
-    } else {
-        lib = _load_module_from_library(
-            target, environment_.system_modules_path(), libname, id);
-        if (lib != nullptr) {
-            handles_[*target] = {libname, environment_.system_modules_path(),
-                                 lib};
-        } else {
+    auto loadpath = environment_.user_modules_path();
+    lib = _load_module_from_library(target, loadpath, libname, id);
+    if (lib == nullptr) {
+        loadpath = environment_.system_modules_path();
+        lib = _load_module_from_library(target, loadpath, libname, id);
+        if (lib == nullptr) {
             return false;
         }
     }
 
-    Log("MODULE_LOADER", handles_[*target].loadpath, " -> ", libname);
+    {
+        std::lock_guard<std::mutex> lock(handles_mutex_);
+        handles_[*target] = {libname, loadpath, lib};
+    }
+
+    Log("MODULE_LOADER", loadpath, " -> ", libname);
     return true;
 }
 
 bool tv::ModuleLoader::destroy_module(ModuleWrapper* module) {
-    auto entry = handles_.find(module);
-    if (entry == handles_.cend()) {  // bug if this happens
-        error_ = TV_INTERNAL_ERROR;
-        return false;
-    }
+    LibraryHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(handles_mutex_);
+        auto entry = handles_.find(module);
+        if (entry == handles_.cend()) {  // bug if this happens
+            error_ = TV_INTERNAL_ERROR;
+            return false;
+        }
 
-    // remove the library from the list of open handles
-    auto handle = entry->second.handle;
-    handles_.erase(module);
+        // remove the library from the list of open handles
+        handle = entry->second.handle;
+        handles_.erase(entry);
+    }
 
     // Destroy the object
     delete module;
@@ -191,6 +197,8 @@ bool tv::ModuleLoader::destroy_module(ModuleWrapper* module) {
 }
 
 void tv::ModuleLoader::destroy_all(void) {
+    std::lock_guard<std::mutex> lock(handles_mutex_);
+
     auto libs = std::vector<LibraryHandle>{};
     for (auto const& lib : handles_) {
         libs.push_back(lib.second.handle);
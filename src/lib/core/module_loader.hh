@@ -26,6 +26,7 @@
 
 #include <unordered_map>
 #include <vector>
+#include <mutex>
 #include <dlfcn.h>
 
 #include "module_wrapper.hh"
@@ -94,9 +95,9 @@ public:
     /// libraries should be closed after this method.
     void destroy_all(void);
 
-    /// Return the last error produced by one of the api methods, if
-    /// any. This should be called whenever one of destroy_module or
-    /// load_module_from_library return false.
+    /// Return the last error produced by one of the api methods in the
+    /// calling thread, if any. This should be called whenever one of
+    /// destroy_module or load_module_from_library return false.
     /// Calling this will also reset the internal error to TV_OK.
     /// \return The last error produced, one of TV*. TV_OK if none.
     int16_t last_error(void);
@@ -166,7 +167,8 @@ private:
     Environment const& environment_;
     AvailableModules availables_;  ///< Keeps track of loadable modules
     Handles handles_;              ///< Keeps track of loaded modules
-    int16_t error_{TV_OK};         ///< If an error occurs, it's stored here
+    std::mutex handles_mutex_;     ///< Modules are loaded concurrently
+    static thread_local int16_t error_;  ///< Last error of the thread
 
     std::vector<std::string> required_functions_ = {
         "create",
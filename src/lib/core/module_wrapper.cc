@@ -27,29 +27,271 @@
 #include "module_wrapper.hh"
 
 #include <cstring>
+#include <cstdlib>
+#include <mutex>
+
+namespace {
+/// Copy a result to its representation in the C interface.
+void convert_result(tv::Result const& result, TV_ModuleResult& cresult) {
+    cresult.x = result.x;
+    cresult.y = result.y;
+    cresult.width = result.width;
+    cresult.height = result.height;
+    std::strncpy(cresult.string, result.result.c_str(), TV_STRING_SIZE - 1);
+    cresult.string[TV_STRING_SIZE - 1] = '\0';
+}
+}
+
+constexpr uint8_t tv::ModuleWrapper::slow_runs_to_async_;
+constexpr int32_t tv::ModuleWrapper::max_parallel_;
 
 void tv::ModuleWrapper::execute(tv::Image const& image) {
-    static decltype(period_) current{0};
-
-    /// Execute the module if period_ is not 0 and the module is scheduled to
-    /// run in this cycle, decided by comparing the value of period_ with an
-    /// internal counter.
-    if (period_ and ++current >= period_) {
-        current = 0;
-        auto result = &tv_module_->execute(image);
-
-        if (callbacks_enabled_ and cb_ and result) {
-            Log("MODULE_WRAPPER", "Callback for ", module_id_, " - ", name());
-            TV_ModuleResult cresult = {result->x, result->y, result->width,
-                                       result->height};
-            std::strncpy(cresult.string, result->result.c_str(),
-                         TV_STRING_SIZE - 1);
-            cresult.string[TV_STRING_SIZE - 1] = '\0';
-            cb_(static_cast<int8_t>(module_id_), cresult, nullptr);
+    /// Execute the module if it has been scheduled to run in this cycle,
+    /// see tick() and Scheduler.
+    if (scheduled_) {
+        // an AsyncLane might execute it, if this is a module_run_now()
+        std::unique_lock<std::mutex> turn(execute_mutex_, std::defer_lock);
+        if (on_lane_) {
+            turn.lock();
+        }
+        _apply_staged();
+
+        auto const& result = tv_module_->execute(image);
+        if (not tv_module_->can_have_result()) {
+            return;
+        }
+        result_slot_.store(result);
+
+        // callbacks are serialized by the dispatcher_
+        std::lock_guard<std::mutex> lock(deliver_mutex_);
+        if ((callbacks_enabled_ and cb_) or bundle_results_) {
+            _deliver(result, image.header.timestamp);
         }
     }
 }
 
+bool tv::ModuleWrapper::execute_instance(Module& instance,
+                                         tv::Image const& image,
+                                         Result& result) {
+    std::unique_lock<std::mutex> turn(execute_mutex_, std::defer_lock);
+    if (&instance == tv_module_) {  // replicas follow by update_replica()
+        turn.lock();
+        _apply_staged();
+    }
+
+    auto const& latest = instance.execute(image);
+    if (not instance.can_have_result()) {
+        return false;
+    }
+
+    result = latest;
+    return true;
+}
+
+void tv::ModuleWrapper::publish(Result const& result, Timestamp timestamp) {
+    result_slot_.store(result);
+
+    std::lock_guard<std::mutex> lock(deliver_mutex_);
+    _deliver(result, timestamp);
+}
+
+void tv::ModuleWrapper::bundle_results(bool bundle) {
+    std::lock_guard<std::mutex> lock(deliver_mutex_);
+    bundle_results_ = bundle;
+    bundle_pending_ = false;
+}
+
+bool tv::ModuleWrapper::take_bundled(TV_FrameResult& result) {
+    std::lock_guard<std::mutex> lock(deliver_mutex_);
+
+    if (not bundle_pending_) {
+        return false;
+    }
+    bundle_pending_ = false;
+    result = bundled_;
+    return true;
+}
+
+void tv::ModuleWrapper::_deliver(Result const& result, Timestamp timestamp) {
+    if (not tv_module_->can_have_result() or _filtered(result, timestamp)) {
+        return;
+    }
+
+    delivered_ = result;
+    delivered_at_ = timestamp;
+    delivered_any_ = true;
+
+    results_++;
+    if (callbacks_enabled_ and cb_) {
+        _callback(result);
+    }
+
+    if (bundle_results_) {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+
+        bundled_.module_id = static_cast<int8_t>(module_id_);
+        bundled_.sequence = results_;
+        bundled_.timestamp_us =
+            duration_cast<microseconds>(timestamp.time_since_epoch()).count();
+        convert_result(result, bundled_.result);
+        bundle_pending_ = true;
+    }
+}
+
+void tv::ModuleWrapper::executing(Timestamp now) {
+    frames_waited_ = 0;
+    auto const interval_ms = interval_ms_.load();
+    if (interval_ms) {
+        auto const interval = std::chrono::milliseconds(interval_ms);
+        // Keep the phase unless it fell behind by more than an interval,
+        // which happens after a pause or if the targeted rate is too high,
+        // or unless it restarts since the interval was changed.
+        auto const restarted =
+            interval_changed_.exchange(false) or next_due_ == Timestamp();
+        next_due_ += interval;
+        if (restarted or next_due_ <= now) {
+            next_due_ = now + interval;
+        }
+    }
+}
+
+void tv::ModuleWrapper::_callback(Result const& result) {
+    Log("MODULE_WRAPPER", "Callback for ", module_id_, " - ", name());
+    TV_ModuleResult cresult;
+    convert_result(result, cresult);
+
+    if (dispatcher_) {
+        (void)dispatcher_->post(channel_, cb_, static_cast<int8_t>(module_id_),
+                                cresult);
+    } else {
+        cb_(static_cast<int8_t>(module_id_), cresult, nullptr);
+    }
+}
+
+bool tv::ModuleWrapper::_filtered(Result const& result,
+                                  Timestamp timestamp) const {
+    if (not delivered_any_) {
+        return false;
+    }
+
+    auto const min_interval = std::chrono::milliseconds(min_interval_ms_);
+    if (min_interval_ms_ and timestamp - delivered_at_ < min_interval) {
+        return true;
+    }
+
+    if (not on_change_ and not deadband_) {
+        return false;
+    }
+
+    // a change within the deadband is no change
+    auto const moved = [this](int32_t value, int32_t previous) {
+        return std::abs(value - previous) > deadband_;
+    };
+    auto const changed = moved(result.x, delivered_.x) or
+                         moved(result.y, delivered_.y) or
+                         moved(result.width, delivered_.width) or
+                         moved(result.height, delivered_.height) or
+                         result.result != delivered_.result;
+    return not changed;
+}
+
+tv::Module* tv::ModuleWrapper::replicate(void) {
+    auto replica = ctor_(envir_);
+    if (not replica) {
+        return nullptr;
+    }
+
+    if (not replica->initialize()) {
+        LogError("MODULE_WRAPPER", "Replicating ", name(), " failed");
+        dtor_(replica);
+        return nullptr;
+    }
+
+    uint32_t version = parameters_changed_ + 1;  // anything else
+    update_replica(*replica, version);
+    return replica;
+}
+
+void tv::ModuleWrapper::update_replica(Module& replica,
+                                       uint32_t& version) const {
+    auto const changed = parameters_changed_.load();
+    if (version == changed) {
+        return;
+    }
+    version = changed;
+
+    std::vector<ParameterValue> values;
+    {
+        std::lock_guard<std::mutex> lock(parameter_values_mutex_);
+        values = parameter_values_;
+    }
+
+    // The built-in parameters are not registered for replicas.
+    for (auto const& value : values) {
+        if (not replica.has_parameter(value.name)) {
+            continue;
+        }
+
+        if (value.numerical) {
+            (void)replica.set(value.name, value.number);
+        } else {
+            (void)replica.set(value.name, value.string);
+        }
+    }
+}
+
+void tv::ModuleWrapper::_snapshot_parameter(Parameter::Handle handle) {
+    auto const& parameter = tv_module_->get_parameter_by_number(handle);
+
+    std::lock_guard<std::mutex> lock(parameter_values_mutex_);
+    if (parameter_values_.size() <= handle) {
+        parameter_values_.resize(handle + 1);
+    }
+
+    auto& value = parameter_values_[handle];
+    value.name = parameter.name();
+    value.numerical = parameter.get(value.number);
+    if (not value.numerical) {
+        (void)parameter.get(value.string);
+    }
+}
+
+bool tv::ModuleWrapper::tick(Timestamp now, uint16_t factor) {
+    auto const period_frames = period_.load();
+    if (not period_frames) {
+        return false;
+    }
+
+    auto const period = period_frames * factor;
+    if (frames_waited_ < period) {
+        frames_waited_++;
+    }
+
+    // a changed interval is due now, see set_parameter()
+    if (interval_changed_.exchange(false)) {
+        next_due_ = Timestamp();
+    }
+
+    auto const interval_ms = interval_ms_.load();
+    auto const shed = std::chrono::milliseconds(interval_ms * (factor - 1));
+    return frames_waited_ >= period and
+           (not interval_ms or next_due_ + shed <= now);
+}
+
+void tv::ModuleWrapper::account_execution(bool slow) {
+    if (async_ != 2 or async_lane_ or outputs_image()) {
+        return;
+    }
+
+    slow_runs_ = slow ? slow_runs_ + 1 : 0;
+    if (slow_runs_ >= slow_runs_to_async_) {
+        Log("MODULE_WRAPPER", "Executing ", name(), " (", module_id_,
+            ") asynchronously from now on");
+        async_lane_ = true;
+    }
+}
+
 tv::ColorSpace tv::ModuleWrapper::expected_format(void) const {
     return tv_module_->expected_format();
 }
@@ -72,22 +314,187 @@ bool tv::ModuleWrapper::has_parameter(std::string const& parameter) const {
     return tv_module_->has_parameter(parameter);
 }
 
+void tv::ModuleWrapper::_resolve_builtins(void) {
+    static std::pair<char const*, Builtin> const names[] = {
+        {"period", Builtin::Period},
+        {"priority", Builtin::Priority},
+        {"parallel", Builtin::Parallel},
+        {"coalesce", Builtin::Coalesce},
+        {"callbacks_enabled", Builtin::CallbacksEnabled},
+        {"on_change", Builtin::OnChange},
+        {"deadband", Builtin::Deadband},
+        {"min_interval_ms", Builtin::MinIntervalMs},
+        {"async", Builtin::Async},
+        {"interval_ms", Builtin::IntervalMs},
+        {"rate_hz", Builtin::RateHz}};
+
+    builtins_.assign(tv_module_->parameter_count(), Builtin::None);
+
+    Parameter::Handle handle;
+    for (auto const& name : names) {
+        if (tv_module_->handle(name.first, handle)) {
+            builtins_[handle] = name.second;
+        }
+    }
+
+    (void)tv_module_->handle("interval_ms", interval_handle_);
+    (void)tv_module_->handle("rate_hz", rate_handle_);
+}
+
 bool tv::ModuleWrapper::set_parameter(std::string const& parameter,
                                       int32_t value) {
+    Parameter::Handle handle;
+    return tv_module_->handle(parameter, handle) and
+           set_parameter(handle, value);
+}
+
+bool tv::ModuleWrapper::set_parameter(Parameter::Handle parameter,
+                                      int32_t value) {
     auto result = tv_module_->set(parameter, value);
 
-    if (result and parameter == "period") {  // save this for faster access
-        period_ = value;
+    if (not result) {
+        return false;
+    }
+    _snapshot_parameter(parameter);
+
+    // save these for faster access
+    auto const builtin =
+        parameter < builtins_.size() ? builtins_[parameter] : Builtin::None;
+    switch (builtin) {
+        case Builtin::None:
+            break;
+
+        case Builtin::Period:
+            period_ = value;
+            break;
+
+        case Builtin::Priority:
+            priority_ = value;
+            break;
+
+        case Builtin::Parallel:
+            parallel_ = value;
+            break;
+
+        case Builtin::Coalesce:
+            channel_->coalesce = (value != 0);
+            break;
+
+        case Builtin::CallbacksEnabled:
+        case Builtin::OnChange:
+        case Builtin::Deadband:
+        case Builtin::MinIntervalMs: {
+            // read by _deliver()
+            std::lock_guard<std::mutex> lock(deliver_mutex_);
+            if (builtin == Builtin::CallbacksEnabled) {
+                callbacks_enabled_ = (value != 0);
+            } else if (builtin == Builtin::OnChange) {
+                on_change_ = (value != 0);
+            } else if (builtin == Builtin::Deadband) {
+                deadband_ = value;
+            } else {
+                min_interval_ms_ = value;
+            }
+            break;
+        }
+
+        case Builtin::Async:
+            // a module outputting an image stays in the mainloop
+            async_ = value;
+            async_lane_ = (value == 1) and not outputs_image();
+            slow_runs_ = 0;
+            break;
+
+        case Builtin::IntervalMs:
+        case Builtin::RateHz: {
+            // both describe the same, the other one is updated accordingly
+            auto const interval =
+                value ? (builtin == Builtin::RateHz ? 1000 / value : value)
+                      : 0;
+            auto const rate = interval ? 1000 / interval : 0;
+            interval_ms_ = interval;
+            interval_changed_ = true;  // due now, applied by the mainloop
+
+            (void)tv_module_->set(interval_handle_, interval);
+            (void)tv_module_->set(rate_handle_, rate);
+            _snapshot_parameter(interval_handle_);
+            _snapshot_parameter(rate_handle_);
+            break;
+        }
     }
 
+    parameters_changed_++;  // replicas follow, see update_replica()
     return result;
 }
 
+bool tv::ModuleWrapper::stage_parameters(ParameterBlock const& values) {
+    HandleBlock handles;
+    handles.reserve(values.size());
+
+    Parameter::Handle handle;
+    for (auto const& value : values) {
+        if (not tv_module_->handle(value.first, handle)) {
+            return false;
+        }
+
+        auto const& parameter = tv_module_->get_parameter_by_number(handle);
+        if (parameter.type() != Parameter::Type::Numerical or
+            value.second < parameter.min() or
+            value.second > parameter.max()) {
+            return false;
+        }
+        handles.emplace_back(handle, value.second);
+    }
+
+    std::lock_guard<std::mutex> lock(stage_mutex_);
+
+    if (not active_) {  // not executed, nothing to synchronize with
+        for (auto const& value : handles) {
+            (void)set_parameter(value.first, value.second);
+        }
+        return true;
+    }
+
+    // Take back the block staged last if it has not been applied yet.  Else
+    // it might still be applied, but the other one has been applied before.
+    auto block = staged_.exchange(nullptr);
+    if (not block) {
+        block = &blocks_[next_block_];
+        next_block_ = 1 - next_block_;
+        block->clear();
+    }
+
+    block->insert(block->end(), handles.cbegin(), handles.cend());
+    staged_ = block;
+    return true;
+}
+
+void tv::ModuleWrapper::_apply_staged(void) {
+    if (not staged_.load()) {  // the common case, without a write
+        return;
+    }
+
+    auto const block = staged_.exchange(nullptr);
+    if (not block) {
+        return;
+    }
+
+    // later values of a parameter override earlier ones
+    for (auto const& value : *block) {
+        (void)set_parameter(value.first, value.second);
+    }
+}
+
 bool tv::ModuleWrapper::set_parameter(std::string const& parameter,
                                       std::string const& value) {
-    return tv_module_->set(parameter, value);
-}
+    Parameter::Handle handle;
+    if (not tv_module_->handle(parameter, handle) or
+        not tv_module_->set(handle, value)) {
+        return false;
+    }
 
-tv::Result const& tv::ModuleWrapper::result(void) const {
-    return tv_module_->result();
+    _snapshot_parameter(handle);
+    parameters_changed_++;
+    return true;
 }
+
@@ -31,12 +31,18 @@
 #include <type_traits>
 #include <cassert>
 #include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
 
 #include "tinkervision_defines.h"
 #include "image.hh"
 #include "bitflag.hh"
 #include "logger.hh"
 #include "module.hh"
+#include "callback_dispatcher.hh"
+#include "result_slot.hh"
 
 namespace tv {
 
@@ -69,22 +75,143 @@ private:
     bool active_{
         false};  ///< True if the module is running (i.e. will be executed)
 
-    ModuleWrapper::Tag tags_{ModuleWrapper::Tag::None};  ///< Runtime tags used
-                                                         /// by the mainloop
+    using TagBits = std::underlying_type<Tag>::type;
+    std::atomic<TagBits> tags_{static_cast<TagBits>(Tag::None)};  ///< Runtime
+    /// tags used by the mainloop, set by any thread
 
     Module* tv_module_{nullptr};  ///< Wrapped module
-    Result latest_result_;        ///< Set after execute if provided
+    ResultSlot result_slot_;      ///< Latest result, set after each execution
 
     TV_Callback cb_ = nullptr;  ///< Callback for results of the wrapped module
     bool callbacks_enabled_{true};  ///< If false, callbacks won't be made. This
                                     /// has only relevance if the wrapped module
                                     /// can_have_result()
+    CallbackDispatcher* dispatcher_{nullptr};  ///< Makes the callbacks
+    std::shared_ptr<CallbackDispatcher::Channel> channel_{
+        std::make_shared<CallbackDispatcher::Channel>()};  ///< Of this module
+
+    uint16_t deadband_{0};  ///< Change of x, y, width or height to deliver
+    bool on_change_{false};  ///< Deliver changed results only?
+    uint16_t min_interval_ms_{0};  ///< Between two results delivered
+    Result delivered_;             ///< Latest result delivered
+    Timestamp delivered_at_;       ///< Frame of delivered_
+    bool delivered_any_{false};    ///< delivered_ is valid?
+
+    bool bundle_results_{false};  ///< Keep results for take_bundled()?
+    TV_FrameResult bundled_;      ///< Latest result not yet taken
+    bool bundle_pending_{false};  ///< bundled_ not yet taken?
+    uint32_t results_{0};         ///< Sequence of the latest result
+
+    uint16_t frames_waited_{0};  ///< Frames since the last execution
+    Timestamp next_due_;         ///< When interval_ms_ is reached next
+    bool scheduled_{true};       ///< Execute during the next execute()?
+
+    // Set by set_parameter(), read by the mainloop
+    std::atomic<uint16_t> period_{1};  ///< An execution frequency for the
+    /// wrapped module. Defaults to 1, which means 'execute every cycle'.
+    /// Set to zero, the module would not execute at all.
+    std::atomic<uint16_t> interval_ms_{0};  ///< Targeted time between two
+    /// executions. Zero means 'as often as period_ allows'.
+    std::atomic<bool> interval_changed_{false};  ///< next_due_ restarts?
+    std::atomic<uint8_t> priority_{5};  ///< Relevant for the Scheduler only
+    std::atomic<uint8_t> async_{2};  ///< Value of parameter async: 0 never,
+                                     /// 1 always, 2 if the module turns out
+                                     /// to be slow.
+    std::atomic<bool> async_lane_{false};  ///< Executed asynchronously, see
+                                           /// AsyncLane
+    std::atomic<uint8_t> slow_runs_{0};  ///< Consecutive executions
+                                         /// exceeding a frame
+    static constexpr uint8_t slow_runs_to_async_ = 5;
+
+    std::atomic<uint8_t> parallel_{1};  ///< Frames executed at once, see
+                                        /// replicate()
+    static constexpr int32_t max_parallel_ = 8;
+    std::atomic<uint32_t> parameters_changed_{0};  ///< Counts set_parameter()
+
+    /// The built-in parameters which are stored redundantly here.
+    enum class Builtin : uint8_t {
+        None,
+        Period,
+        Priority,
+        Parallel,
+        Coalesce,
+        CallbacksEnabled,
+        OnChange,
+        Deadband,
+        MinIntervalMs,
+        Async,
+        IntervalMs,
+        RateHz
+    };
+    std::vector<Builtin> builtins_;        ///< Indexed by parameter handle
+    Parameter::Handle interval_handle_{0};  ///< Handle of interval_ms
+    Parameter::Handle rate_handle_{0};      ///< Handle of rate_hz
 
-    uint8_t period_{1};  ///< An execution frequency for the wrapped module.
-                         /// Defaults to 1, which means 'execute every cycle'.
-                         /// Set to zero, the module would not execute at all.
-
+    Constructor ctor_;
     Destructor dtor_;
+    Environment const& envir_;
+
+public:
+    /// Numerical values of several parameters, by name.
+    using ParameterBlock = std::vector<std::pair<std::string, int32_t>>;
+
+private:
+    /// Numerical values of several parameters, by handle.
+    using HandleBlock = std::vector<std::pair<Parameter::Handle, int32_t>>;
+
+    HandleBlock blocks_[2];  ///< Filled alternately by stage_parameters()
+    size_t next_block_{0};   ///< Index into blocks_ filled next
+    std::atomic<HandleBlock*> staged_{nullptr};  ///< Not applied yet
+    std::mutex stage_mutex_;  ///< Serializes stage_parameters()
+    std::mutex execute_mutex_;  ///< Serializes the executions of tv_module_
+    /// by execute() and execute_instance()
+    std::atomic<bool> on_lane_{false};  ///< An AsyncLane may execute
+    /// tv_module_, see execute_on_lane()
+    std::mutex deliver_mutex_;  ///< Guards the state used by _deliver(),
+    /// which is called by the executing thread
+
+    /// Value of a parameter of tv_module_ as set last.
+    struct ParameterValue {
+        std::string name;
+        bool numerical;  ///< Else, string is valid
+        int32_t number;
+        std::string string;
+    };
+
+    /// Values of all parameters, by handle, from which replicas are updated
+    /// since tv_module_ may be changed or executed meanwhile.
+    std::vector<ParameterValue> parameter_values_;
+    mutable std::mutex parameter_values_mutex_;  ///< Guards parameter_values_
+
+    /// Fill builtins_ from the names of the registered parameters.  Called
+    /// once, after initialization.
+    void _resolve_builtins(void);
+
+    /// Copy the value of a parameter to parameter_values_.  Called by the
+    /// thread which set it, before counting the change.
+    /// \param[in] handle Handle of the parameter.
+    void _snapshot_parameter(Parameter::Handle handle);
+
+    /// Set the values of the staged_ block, if any.  Called by the thread
+    /// executing the wrapped module, right before an execution.
+    void _apply_staged(void);
+
+    /// Pass a result to the registered callback, through the dispatcher_ if
+    /// set.  Called with deliver_mutex_ held.
+    void _callback(Result const& result);
+
+    /// Pass a new result on, to the callback and to bundled_, as requested,
+    /// unless _filtered().
+    /// \param[in] result The result.
+    /// \param[in] timestamp Of the frame the result was produced for.
+    void _deliver(Result const& result, Timestamp timestamp);
+
+    /// Check a result against the parameters deadband, on_change and
+    /// min_interval_ms, comparing it to the result delivered last.
+    /// \param[in] result The result.
+    /// \param[in] timestamp Of the frame the result was produced for.
+    /// \return True if the result shall not be delivered.
+    bool _filtered(Result const& result, Timestamp timestamp) const;
 
 public:
     ModuleWrapper(Constructor ctor, Destructor dtor, int16_t module_id,
@@ -92,7 +219,9 @@ public:
         : load_path_(load_path),
           module_id_(module_id),
           tv_module_(ctor(envir)),
-          dtor_(dtor) {}
+          ctor_(ctor),
+          dtor_(dtor),
+          envir_(envir) {}
 
     ~ModuleWrapper(void) {
         Log("MODULE::Destructor", name());
@@ -115,10 +244,120 @@ public:
         return true;
     }
 
-    /// Execute the wrapped module with the given image.
+    /// Deliver the results to the callback from the thread of a dispatcher
+    /// instead of the thread executing the module.
+    /// \param[in] dispatcher Has to outlive this, or nullptr to call back
+    /// directly.
+    void dispatch_callbacks(CallbackDispatcher* dispatcher) {
+        dispatcher_ = dispatcher;
+    }
+
+    /// Keep the latest result until take_bundled(), to deliver the results
+    /// of all modules at once.
+    /// \param[in] bundle False to stop keeping results.
+    void bundle_results(bool bundle);
+
+    /// Take the result produced since the last call, if any.
+    /// \param[out] result Set if a result is available.
+    /// \return False if there is no new result, or bundle_results() is off.
+    bool take_bundled(TV_FrameResult& result);
+
+    /// Execute the wrapped module with the given image, if it has been
+    /// schedule()'d for this frame.
     /// \param[in] image The current frame
     void execute(tv::Image const& image);
 
+    /// Execute the wrapped module or one of its replicate()'s regardless of
+    /// the schedule, as done by the AsyncLane.  Different instances may be
+    /// executed concurrently, the wrapped module itself not concurrently to
+    /// execute().  No callback is made, the result has to be publish()'d.
+    /// \param[in] instance executable() or a replica.
+    /// \param[in] image The frame.
+    /// \param[out] result The result of the instance.
+    /// \return True if the module can have a result.
+    bool execute_instance(Module& instance, tv::Image const& image,
+                          Result& result);
+
+    /// Mark the wrapped module as executed by an AsyncLane, which execute()
+    /// has to take turns with then.  Called by the mainloop, between the
+    /// executions of execute().
+    /// \param[in] on_lane False once the lane has stopped.
+    void execute_on_lane(bool on_lane) { on_lane_ = on_lane; }
+
+    /// Make the callback for a result of execute_instance(), which will be
+    /// the latest result() if more than one instance is used.  Has to be
+    /// called in the order of the frames.
+    /// \param[in] result The result.
+    /// \param[in] timestamp Of the frame the result was produced for.
+    void publish(Result const& result, Timestamp timestamp);
+
+    /// Construct another instance of the wrapped module with the same
+    /// parameters.  Possible if the module is stateless.
+    /// \return The replica, which has to be passed to destroy_replica(), or
+    /// nullptr if construction failed.
+    Module* replicate(void);
+
+    /// Update the parameters of a replica if they were changed since.
+    /// \param[in] replica Constructed by replicate().
+    /// \param[in,out] version Last value returned for this replica.
+    void update_replica(Module& replica, uint32_t& version) const;
+
+    /// Destroy an instance constructed by replicate().
+    /// \param[in] replica The replica.
+    void destroy_replica(Module* replica) { dtor_(replica); }
+
+    /// Get the number of frames to be executed at once, as requested by the
+    /// parameter parallel, by as many instances.
+    /// \return 1 unless the module is stateless.
+    uint8_t parallel(void) const { return parallel_; }
+
+    /// Count a new frame and check whether the wrapped module should be
+    /// executed, according to the parameters period, interval_ms and
+    /// rate_hz.  Must be called once per frame.
+    /// \param[in] now Timestamp of the current frame.
+    /// \param[in] factor Lowers the rate by this factor, see
+    /// OverloadController.
+    /// \return True if the module is due.
+    bool tick(Timestamp now, uint16_t factor);
+
+    /// Decide whether execute() will run the wrapped module.
+    /// \param[in] scheduled If false, the next execute() is skipped.
+    void schedule(bool scheduled) { scheduled_ = scheduled; }
+
+    /// Check whether execute() will run the wrapped module.
+    /// \return scheduled_.
+    bool scheduled(void) const { return scheduled_; }
+
+    /// Update the schedule for an execution on the frame with timestamp now.
+    /// Called by the mainloop once it decided to execute the module on that
+    /// frame, since execute() itself might run on any thread.
+    /// \param[in] now Timestamp of the current frame.
+    void executing(Timestamp now);
+
+    /// Check whether the wrapped module is executed asynchronously to the
+    /// mainloop, which is decided by the parameters async and parallel.
+    /// \return True if the module belongs to an AsyncLane.
+    bool async(void) const { return async_lane_ or parallel_ > 1; }
+
+    /// Account for the duration of an execution in the mainloop.  If
+    /// parameter async is 2 and the module does not output an image, which
+    /// later modules would depend on, it is moved to an AsyncLane after a
+    /// few slow executions in a row.
+    /// \param[in] slow True if the execution took longer than a frame.
+    void account_execution(bool slow);
+
+    /// Get the targeted time between two executions.
+    /// \return interval_ms_, 0 if executed every (period_'th) frame.
+    uint16_t interval_ms(void) const { return interval_ms_; }
+
+    /// Get the scheduling priority.
+    /// \return priority_, higher values being preferred.
+    uint8_t priority(void) const { return priority_; }
+
+    /// Get the time at which the wrapped module is due next.
+    /// \return next_due_, only meaningful if interval_ms() is not 0.
+    Timestamp const& next_due(void) const { return next_due_; }
+
     /// Try to initialize the wrapped module.
     /// \return \c false if initialization failed.
     bool initialize(void) {
@@ -132,12 +371,38 @@ public:
         if (tv_module_->produces_result()) {
             initialized_ =
                 tv_module_->register_parameter("result_timeout", 0, 40, 20) and
-                tv_module_->register_parameter("callbacks_enabled", 0, 1, 1);
+                tv_module_->register_parameter("callbacks_enabled", 0, 1, 1) and
+                tv_module_->register_parameter("coalesce", 0, 1, 1) and
+                tv_module_->register_parameter("on_change", 0, 1, 0) and
+                tv_module_->register_parameter("deadband", 0, 1000, 0) and
+                tv_module_->register_parameter("min_interval_ms", 0, 60000,
+                                               0);
+        }
+
+        initialized_ =
+            initialized_ and
+            tv_module_->register_parameter("period", 0, 500, 1) and
+            tv_module_->register_parameter("interval_ms", 0, 60000, 0) and
+            tv_module_->register_parameter("rate_hz", 0, 1000, 0) and
+            (tv_module_->has_parameter("priority") or  // module's default
+             tv_module_->register_parameter("priority", 0, 10, 5)) and
+            tv_module_->register_parameter("async", 0, 2, 2) and
+            ((not tv_module_->stateless() or tv_module_->outputs_image()) or
+             tv_module_->register_parameter("parallel", 1, max_parallel_,
+                                            1)) and
+            tv_module_->initialize();
+
+        if (initialized_) {
+            _resolve_builtins();
+            for (size_t i = 0; i < get_parameter_count(); ++i) {
+                _snapshot_parameter(static_cast<Parameter::Handle>(i));
+            }
         }
 
-        initialized_ = initialized_ and
-                       tv_module_->register_parameter("period", 0, 500, 1) and
-                       tv_module_->initialize();
+        int32_t priority;
+        if (initialized_ and tv_module_->get("priority", priority)) {
+            priority_ = static_cast<uint8_t>(priority);
+        }
 
         return initialized_;
     }
@@ -188,6 +453,10 @@ public:
 
     ColorSpace expected_format(void) const;
 
+    /// Check whether the wrapped module provides a modified image.
+    /// \return True if modified_image() is valid after execution.
+    bool outputs_image(void) const { return tv_module_->outputs_image_; }
+
     /// Get the list of parameters valid for this module.
     /// \return The list of parameters.
     void get_parameters_list(std::vector<Parameter const*>& parameters) const;
@@ -197,6 +466,22 @@ public:
     /// \return true if the parameter is supported.
     bool has_parameter(std::string const& parameter) const;
 
+    /// Check if a module supports a parameter.
+    /// \param[in] parameter Handle of the parameter.
+    /// \return true if the parameter is supported.
+    bool has_parameter(Parameter::Handle parameter) const {
+        return parameter < tv_module_->parameter_count();
+    }
+
+    /// Get the handle of a parameter, see Module::handle().
+    /// \param[in] parameter The name of the parameter.
+    /// \param[out] handle Will be set accordingly on success.
+    /// \return True if such a parameter exists.
+    bool parameter_handle(std::string const& parameter,
+                          Parameter::Handle& handle) const {
+        return tv_module_->handle(parameter, handle);
+    }
+
     /// Get the current value of a parameter.
     /// \param[in] parameter The name of the parameter.
     /// \param[out] value Will be set accordingly on success.
@@ -206,6 +491,15 @@ public:
         return tv_module_->get(parameter, value);
     }
 
+    /// Get the current value of a parameter.
+    /// \param[in] parameter The handle of the parameter.
+    /// \param[out] value Will be set accordingly on success.
+    /// \return True if such a parameter exists (value is valid and type is T).
+    template <typename T>
+    bool get_parameter(Parameter::Handle parameter, T& value) {
+        return tv_module_->get(parameter, value);
+    }
+
     /// Set the value of a parameter.
     /// \param[in] parameter The name of the parameter.
     /// \param[in] value The value.
@@ -213,6 +507,13 @@ public:
     /// if the range of the parameter is limited.
     bool set_parameter(std::string const& parameter, int32_t value);
 
+    /// Set the value of a parameter.
+    /// \param[in] parameter The handle of the parameter.
+    /// \param[in] value The value.
+    /// \return true, if the parameter has value \c value now. This might fail
+    /// if the range of the parameter is limited.
+    bool set_parameter(Parameter::Handle parameter, int32_t value);
+
     /// Set the value of a string parameter.
     /// \param[in] parameter The name of the parameter.
     /// \param[in] value The value.
@@ -220,6 +521,18 @@ public:
     /// if the range of the parameter is limited.
     bool set_parameter(std::string const& parameter, std::string const& value);
 
+    /// Set the values of several numerical parameters at once.  If the
+    /// module is enabled, the values are staged and applied together right
+    /// before its next execution, so that no execution sees only part of
+    /// them.  Until then, get_parameter() returns the previous values.
+    /// Values staged before the previous ones were applied are merged.  The
+    /// executing thread takes staged values without a lock: two blocks are
+    /// filled alternately, one of which may be in use by that thread.
+    /// \param[in] values The parameters and their values.
+    /// \return False, and nothing is set, if a parameter is not numerical
+    /// or a value is out of its range.
+    bool stage_parameters(ParameterBlock const& values);
+
     Parameter const& get_parameter_by_number(size_t number) const {
         return tv_module_->get_parameter_by_number(number);
     }
@@ -239,16 +552,20 @@ public:
         return tv_module_->get_parameter_by_number(number);
     }
 
-    /// Retrieve the result of the latest execute().
-    /// \return Latest or an invalid result.
-    Result const& result(void) const;
+    /// Retrieve the result of the latest execution, which is stored once
+    /// per execution.  Can be called from any thread without locking.
+    /// \param[out] result The latest result, if valid.
+    /// \return False if the latest execution did not provide a valid result.
+    bool result(TV_ModuleResult& result) const {
+        return result_slot_.load(result);
+    }
 
     tv::Image const& modified_image(void) {
         return tv_module_->modified_image();
     }
 
-    Tag const& tags(void) const { return tags_; }
-    void tag(Tag tags) { tags_ |= tags; }
+    Tag tags(void) const { return static_cast<Tag>(tags_.load()); }
+    void tag(Tag tags) { tags_ |= static_cast<TagBits>(tags); }
 
     Module* executable(void) { return tv_module_; }
 };
@@ -41,35 +41,58 @@ tv::Node::Node(int16_t node_id, int16_t scene_id, int16_t module_id,
     Log("NODE::c'tor", "Done");
 }
 
-void tv::Node::execute(ModuleExecutor executor, tv::Timestamp timestamp) {
+void tv::Node::execute(ModuleExecutor executor, tv::Timestamp timestamp,
+                       FrameConversions& input, WorkerPool& pool) {
 
     Log("NODE::Execute", "(",
         (void*)this);  //, ", module ", module_id_, ") at ",
     //        timestamp);
 
+    auto branch_input = &input;
+
     if (timestamp_ != timestamp) {
         timestamp_ = timestamp;
 
-        executor(module_id_);
+        auto output = executor(module_id_, input);
+        if (output) {
+            output_.set_frame(*output);
+            branch_input = &output_;
+        }
     }
 
-    // depth-first recursion
-    for (auto node : children_) {
-        node->execute(executor, timestamp);
+    if (children_.empty()) {
+        return;
     }
+
+    // siblings in parallel, the first one continuing in this task
+    for (size_t i = 1; i < children_.size(); ++i) {
+        auto node = children_[i];
+        pool.spawn([node, executor, timestamp, branch_input, &pool](void) {
+            node->execute(executor, timestamp, *branch_input, pool);
+        });
+    }
+    children_.front()->execute(executor, timestamp, *branch_input, pool);
 }
 
 void tv::Node::execute_for_scene(ModuleExecutor executor,
-                                 tv::Timestamp timestamp, int16_t scene_id) {
+                                 tv::Timestamp timestamp,
+                                 FrameConversions& input, int16_t scene_id) {
+    auto branch_input = &input;
+
     if (timestamp_ != timestamp) {
         timestamp_ = timestamp;
 
-        executor(module_id_);
+        auto output = executor(module_id_, input);
+        if (output) {
+            output_.set_frame(*output);
+            branch_input = &output_;
+        }
     }
 
     for (auto node : children_) {
         if (node->is_used_by_scene(scene_id)) {
-            node->execute_for_scene(executor, timestamp, scene_id);
+            node->execute_for_scene(executor, timestamp, *branch_input,
+                                    scene_id);
         }
     }
 }
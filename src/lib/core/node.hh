@@ -33,7 +33,9 @@
 
 #include "module_wrapper.hh"
 #include "image.hh"
+#include "convert.hh"
 #include "shared_resource.hh"
+#include "worker_pool.hh"
 
 namespace tv {
 using Modules = tv::SharedResource<tv::ModuleWrapper>;
@@ -42,7 +44,11 @@ class SceneTree;  // forward
 class Node {
 
 public:
-    using ModuleExecutor = std::function<void(int16_t id)>;
+    /// Executes the module with the given id on the frame provided by the
+    /// conversions passed.  Returns the output image of the module, if it
+    /// provides one, else nullptr.
+    using ModuleExecutor =
+        std::function<Image const*(int16_t id, FrameConversions& input)>;
 
     // default c'tor to be able to store in container types
     Node(void) noexcept(noexcept(std::vector<Node*>()) and
@@ -61,15 +67,22 @@ public:
 
     int16_t id(void) const { return id_; }
 
-    /// Execute the module held by this node.
+    /// Execute the module held by this node, then the child nodes.
+    /// The children get the output of this node's module as input, or the
+    /// input of this node if the module does not output an image.  Since
+    /// sibling branches do not depend on each other, all but the first child
+    /// are spawned as separate tasks to the pool.
     ///
     /// \code module will only be executed if the provided timestamp
     /// is different from \code timestamp_.
     /// \param[in] executor The function to be called on the module.
     /// \param[in] timestamp The image to be processed.
-    void execute(ModuleExecutor executor, Timestamp timestamp);
+    /// \param[in] input The frame to be processed in the required formats.
+    /// \param[in] pool Runs the sibling branches.
+    void execute(ModuleExecutor executor, Timestamp timestamp,
+                 FrameConversions& input, WorkerPool& pool);
     void execute_for_scene(ModuleExecutor executor, Timestamp timestamp,
-                           int16_t scene_id);
+                           FrameConversions& input, int16_t scene_id);
 
     int16_t module_id(void) const { return module_id_; }
 
@@ -140,6 +153,7 @@ public:
 
 private:
     Timestamp timestamp_;
+    FrameConversions output_;  ///< Output of the module, input of children
     int16_t id_{TV_UNUSED_ID};
     int16_t module_id_{TV_UNUSED_ID};
 
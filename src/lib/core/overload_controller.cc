@@ -0,0 +1,82 @@
+/// \file overload_controller.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Implementation of class OverloadController.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "overload_controller.hh"
+
+#include "logger.hh"
+
+constexpr uint8_t tv::OverloadController::critical_priority;
+constexpr uint8_t tv::OverloadController::max_level;
+constexpr uint8_t tv::OverloadController::overruns_to_raise_;
+constexpr uint8_t tv::OverloadController::underruns_to_lower_;
+constexpr uint8_t tv::OverloadController::underrun_percentage_;
+
+bool tv::OverloadController::update(Clock::duration frametime,
+                                    Clock::duration budget) {
+    // moving average, the first measurement taken as is
+    auto average = Clock::duration(frametime_.load());
+    average = average.count() ? (average * 3 + frametime) / 4 : frametime;
+    frametime_ = average.count();
+
+    if (not budget.count()) {
+        return false;
+    }
+
+    if (average > budget) {
+        underruns_ = 0;
+        if (++overruns_ < overruns_to_raise_ or level_ == max_level) {
+            return false;
+        }
+        overruns_ = 0;
+        level_++;
+
+    } else if (average * 100 < budget * underrun_percentage_) {
+        overruns_ = 0;
+        if (++underruns_ < underruns_to_lower_ or level_ == 0) {
+            return false;
+        }
+        underruns_ = 0;
+        level_--;
+
+    } else {
+        overruns_ = underruns_ = 0;
+        return false;
+    }
+
+    Log("OVERLOAD", "Level ", static_cast<int>(level_), ", frametime ",
+        std::chrono::duration_cast<std::chrono::milliseconds>(average)
+            .count(),
+        "ms, budget ",
+        std::chrono::duration_cast<std::chrono::milliseconds>(budget).count(),
+        "ms");
+    return true;
+}
+
+void tv::OverloadController::reset(void) {
+    level_ = overruns_ = underruns_ = 0;
+    frametime_ = 0;
+}
@@ -0,0 +1,90 @@
+/// \file overload_controller.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of class OverloadController.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef OVERLOAD_CONTROLLER_H
+#define OVERLOAD_CONTROLLER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "image.hh"
+
+namespace tv {
+
+/// Watches the time needed to process a frame against the time available,
+/// which is the period in which frames are captured.  If the processing
+/// overruns the period repeatedly, the shedding level is raised by one, which
+/// halves the rate of all best-effort modules.  If the processing is well
+/// below the period for a while, the level is lowered again.  Modules with a
+/// priority of at least critical_priority are never shed.
+/// Only level() and frametime() may be called concurrently to the others.
+class OverloadController {
+public:
+    static constexpr uint8_t critical_priority = 8;  ///< Never shed from here
+    static constexpr uint8_t max_level = 4;  ///< Best-effort every 16th frame
+
+private:
+    static constexpr uint8_t overruns_to_raise_ = 5;      ///< Frames
+    static constexpr uint8_t underruns_to_lower_ = 30;    ///< Frames
+    static constexpr uint8_t underrun_percentage_ = 60;   ///< Of the budget
+
+    std::atomic<uint8_t> level_{0};  ///< Current shedding level
+    uint8_t overruns_{0};    ///< Consecutive frames overrunning the budget
+    uint8_t underruns_{0};   ///< Consecutive frames well below the budget
+    std::atomic<Clock::rep> frametime_{0};  ///< Averaged processing time,
+    /// in Clock::duration ticks
+
+public:
+    /// Account for a processed frame.
+    /// \param[in] frametime The time needed to process the frame.
+    /// \param[in] budget The time available per frame. If zero, nothing
+    /// happens.
+    /// \return True if the shedding level changed.
+    bool update(Clock::duration frametime, Clock::duration budget);
+
+    /// Reset to no shedding, e.g. after the execution has been paused.
+    void reset(void);
+
+    /// Get the current shedding level.
+    /// \return level_, where 0 means no shedding.
+    uint8_t level(void) const { return level_; }
+
+    /// Get the averaged processing time of a frame.
+    /// \return frametime_.
+    Clock::duration frametime(void) const {
+        return Clock::duration(frametime_.load());
+    }
+
+    /// Get the factor by which the rate of a module is lowered.
+    /// \param[in] priority Priority of the module.
+    /// \return 1 for critical modules, else \c 2^level().
+    uint16_t shed_factor(uint8_t priority) const {
+        return priority >= critical_priority ? 1 : 1 << level_;
+    }
+};
+}
+#endif
@@ -0,0 +1,128 @@
+/// \file result_slot.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declares and defines the class \c ResultSlot.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef RESULT_SLOT_H
+#define RESULT_SLOT_H
+
+#include <atomic>
+#include <array>
+#include <cstring>
+#include <cstdint>
+
+#include "tinkervision_defines.h"
+#include "result.hh"
+
+namespace tv {
+
+/// Holds the latest result of a module, to be read from any thread without
+/// locking or allocating.  The slot is a seqlock: the writer makes the
+/// sequence odd, stores the result and makes the sequence even again.  A
+/// reader copies the result and retries if the sequence was odd or changed
+/// meanwhile.  The result is kept in atomic words, so that a torn copy is
+/// discarded instead of being undefined.  Concurrent writers are serialized
+/// on the sequence, but a slot is meant to be written once per execution of
+/// a module.
+class ResultSlot {
+public:
+    /// Store a result, valid or not.
+    /// \param[in] result The result, converted to its C representation.
+    void store(Result const& result) {
+        Entry entry;
+        entry.valid = static_cast<bool>(result);
+        entry.result.x = result.x;
+        entry.result.y = result.y;
+        entry.result.width = result.width;
+        entry.result.height = result.height;
+        std::strncpy(entry.result.string, result.result.c_str(),
+                     TV_STRING_SIZE - 1);
+        entry.result.string[TV_STRING_SIZE - 1] = '\0';
+
+        Words words{};
+        std::memcpy(words.data(), &entry, sizeof(entry));
+
+        // take the slot, a concurrent writer would have left it odd
+        auto sequence = sequence_.load(std::memory_order_relaxed);
+        do {
+            while (sequence & 1) {
+                sequence = sequence_.load(std::memory_order_relaxed);
+            }
+        } while (not sequence_.compare_exchange_weak(
+            sequence, sequence + 1, std::memory_order_acquire,
+            std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < words.size(); ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /// Copy the result stored last.
+    /// \param[out] result The result, if valid.
+    /// \return False if no valid result has been stored.
+    bool load(TV_ModuleResult& result) const {
+        Words words{};
+        while (true) {
+            auto const sequence = sequence_.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                continue;  // being written
+            }
+
+            for (size_t i = 0; i < words.size(); ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == sequence) {
+                break;
+            }
+        }
+
+        Entry entry;
+        std::memcpy(&entry, words.data(), sizeof(entry));
+        if (not entry.valid) {
+            return false;
+        }
+        result = entry.result;
+        return true;
+    }
+
+private:
+    struct Entry {
+        TV_ModuleResult result;
+        bool valid;
+    };
+
+    using Word = uint64_t;
+    using Words = std::array<Word, (sizeof(Entry) + sizeof(Word) - 1) /
+                                       sizeof(Word)>;
+
+    std::atomic<uint32_t> sequence_{0};  ///< Odd while being written
+    std::array<std::atomic<Word>, std::tuple_size<Words>::value>
+        words_{};  ///< The Entry stored last, initially invalid
+};
+}
+#endif
@@ -45,9 +45,9 @@ public:
     ~Scene(void) = default;
 
     /// Depth-first execution of this scene.
-    void execute(std::function<void(int16_t module_id)> executor,
-                 tv::Timestamp timestamp) {
-        tree().execute_for_scene(executor, timestamp, id_);
+    void execute(Node::ModuleExecutor executor, tv::Timestamp timestamp,
+                 FrameConversions& input) {
+        tree().execute_for_scene(executor, timestamp, input, id_);
     }
 
     int16_t id(void) const { return id_; }
@@ -131,12 +131,18 @@ int16_t tv::SceneTrees::add_to_scene(int16_t scene_id, int16_t module_id) {
 }
 
 void tv::SceneTrees::exec_all(Node::ModuleExecutor executor,
-                              Timestamp timestamp) {
+                              Timestamp timestamp, FrameConversions& input,
+                              WorkerPool& pool) {
+    tree_tasks_.clear();
     for (auto& tree : scene_trees_) {
         tree->log_scenes();
         Log("SCENETREES::exec_all", "Moduletree: ", *tree);
-        tree->execute(executor, timestamp);
+        tree_tasks_.push_back([tree, executor, timestamp, &input, &pool](void) {
+            tree->execute(executor, timestamp, input, pool);
+        });
     }
+
+    pool.run_all(tree_tasks_);
 }
 
 void tv::SceneTrees::exec_scene(int16_t scene_id) {}
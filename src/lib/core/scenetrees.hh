@@ -107,9 +107,15 @@ public:
         }
     }
 
-    void execute(Node::ModuleExecutor executor, Timestamp timestamp) {
+    /// Execute the tree, spawning independent branches to the pool.
+    /// \param[in] executor The function to be called on each module.
+    /// \param[in] timestamp The image to be processed.
+    /// \param[in] input The frame in the formats required.
+    /// \param[in] pool Pool running this call.
+    void execute(Node::ModuleExecutor executor, Timestamp timestamp,
+                 FrameConversions& input, WorkerPool& pool) {
         std::lock_guard<std::mutex> lock(exec_lock_);
-        root_->execute(executor, timestamp);
+        root_->execute(executor, timestamp, input, pool);
     }
 
     bool active(void) const { return active_; }
@@ -124,6 +130,7 @@ private:
 
     Nodes scene_nodes_;
     std::vector<SceneTree*> scene_trees_;
+    WorkerPool::Tasks tree_tasks_;  ///< Reused by exec_all()
 
 public:
     static_assert(noexcept(Node()), "node");
@@ -160,7 +167,15 @@ public:
     /// - #TV_INVALID_ID one of both id's is invalid.
     int16_t add_to_scene(int16_t scene_id, int16_t module_id);
 
-    void exec_all(Node::ModuleExecutor executor, Timestamp timestamp);
+    /// Execute all trees on the same frame.  The trees and their branches
+    /// are run concurrently on the pool, this returns once all of them are
+    /// done.
+    /// \param[in] executor The function to be called on each module.
+    /// \param[in] timestamp The image to be processed.
+    /// \param[in] input The frame in the formats required.
+    /// \param[in] pool Runs the trees.
+    void exec_all(Node::ModuleExecutor executor, Timestamp timestamp,
+                  FrameConversions& input, WorkerPool& pool);
     void exec_scene(int16_t scene_id);
 
 private:
@@ -0,0 +1,108 @@
+/// \file scheduler.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Implementation of class Scheduler.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "scheduler.hh"
+
+#include <algorithm>
+#include <cmath>
+
+#include "logger.hh"
+
+void tv::Scheduler::schedule(SharedResource<ModuleWrapper>& modules,
+                             Timestamp now,
+                             OverloadController const& overload) {
+    _measure(now);
+
+    // expected number of timed executions per frame
+    auto load = 0.0;
+
+    due_.clear();
+    modules.exec_all([&](int16_t, ModuleWrapper& module) {
+        if (not module.enabled()) {
+            return;
+        }
+
+        auto const factor = overload.shed_factor(module.priority());
+        auto const due = module.tick(now, factor);
+        if (not module.interval_ms()) {
+            _schedule(module, due, now);
+            return;
+        }
+
+        load += std::chrono::duration<double, std::milli>(frame_interval_)
+                    .count() /
+                (module.interval_ms() * factor);
+
+        module.schedule(false);
+        if (due) {
+            due_.push_back(&module);
+        }
+    });
+
+    if (due_.empty()) {
+        return;
+    }
+
+    auto const budget =
+        std::max(static_cast<size_t>(1), static_cast<size_t>(std::ceil(load)));
+
+    if (due_.size() > budget) {
+        std::sort(due_.begin(), due_.end(),
+                  [](ModuleWrapper const* lhs, ModuleWrapper const* rhs) {
+            return lhs->priority() != rhs->priority()
+                       ? lhs->priority() > rhs->priority()
+                       : lhs->next_due() < rhs->next_due();
+        });
+        LogDebug("SCHEDULER", "Deferring ", due_.size() - budget, " modules");
+    }
+
+    for (size_t i = 0; i < std::min(budget, due_.size()); ++i) {
+        _schedule(*due_[i], true, now);
+    }
+}
+
+void tv::Scheduler::_schedule(ModuleWrapper& module, bool due, Timestamp now) {
+    module.schedule(due);
+
+    // Asynchronous modules are accounted for once their lane takes the frame.
+    if (due and not module.async()) {
+        module.executing(now);
+    }
+}
+
+void tv::Scheduler::_measure(Timestamp now) {
+    if (latest_frame_ != Timestamp() and now > latest_frame_) {
+        auto const interval = now - latest_frame_;
+
+        // moving average, the first measurement taken as is
+        frame_interval_ = frame_interval_.count()
+                              ? (frame_interval_ * 7 + interval) / 8
+                              : interval;
+    }
+
+    latest_frame_ = now;
+}
@@ -0,0 +1,77 @@
+/// \file scheduler.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of class Scheduler.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <vector>
+
+#include "image.hh"
+#include "module_wrapper.hh"
+#include "shared_resource.hh"
+#include "overload_controller.hh"
+
+namespace tv {
+
+/// Decides each frame which modules are executed.
+/// Modules without a targeted interval (parameters interval_ms or rate_hz)
+/// are executed whenever their period is reached.  The others are executed
+/// once their interval elapsed, but only as many of them per frame as their
+/// summed rates require on average.  Surplus modules due in the same frame
+/// are deferred to the next frame(s), preferring those with higher priority
+/// and those waiting longer, which spreads modules with low rates across
+/// frames instead of executing them all in the same one.  The rates of
+/// best-effort modules are lowered further as requested by an
+/// OverloadController.
+class Scheduler {
+private:
+    std::vector<ModuleWrapper*> due_;  ///< Timed modules due this frame
+    Timestamp latest_frame_;           ///< Timestamp of the previous frame
+    Clock::duration frame_interval_{0};  ///< Averaged time between frames
+
+    /// Update frame_interval_.
+    /// \param[in] now Timestamp of the current frame.
+    void _measure(Timestamp now);
+
+    /// Set whether module is executed on the current frame.
+    /// \param[in] module The module.
+    /// \param[in] due True if the module is executed.
+    /// \param[in] now Timestamp of the current frame.
+    void _schedule(ModuleWrapper& module, bool due, Timestamp now);
+
+public:
+    /// Schedule the modules for the current frame.  Calls
+    /// ModuleWrapper::tick() and ModuleWrapper::schedule() on each enabled
+    /// module, so this must be run once per frame before the execution.
+    /// \param[in] modules The modules to be scheduled.
+    /// \param[in] now Timestamp of the current frame.
+    /// \param[in] overload Decides how much the modules are shed.
+    void schedule(SharedResource<ModuleWrapper>& modules, Timestamp now,
+                  OverloadController const& overload);
+};
+}
+#endif
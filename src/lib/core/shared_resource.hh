@@ -21,6 +21,20 @@
 /// It still serves as a basic RAII-style container and can be improved upon if
 /// necessary.
 ///
+/// The execution loops (exec_all(), exec_grouped(), exec_if()) do not lock
+/// anymore.  Each change of the managed resources publishes an immutable copy
+/// of them, in execution order, which the loops iterate.  A resource removed
+/// meanwhile is retired instead of released, and reclaimed by reclaim() once
+/// no loop can still access it.  This is decided by epochs: a loop registers
+/// with the epoch current when it starts, and the epoch is only advanced when
+/// no loop of the previous one is left.
+///
+/// The loops and the calls interrupting them (exec_one_now(), interrupt())
+/// take turns on the resources.  A thread waiting for its turn sleeps on a
+/// condition variable, an interrupting call for a limited time only, see
+/// interrupt_timeout().  Waiting interrupts are served before the loops
+/// continue.
+///
 /// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
 /// \sa https://github.com/Tinkerforge/red-brick
 ///
@@ -49,15 +63,21 @@
 #endif
 
 #include <shared_mutex>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <atomic>
 #include <unordered_map>
 #include <list>
+#include <vector>
 #include <algorithm>
 #include <functional>
+#include <limits>
 
 #include "tinkervision_defines.h"
 #include "exceptions.hh"
 #include "logger.hh"
+#include "time_source.hh"
 
 namespace tv {
 
@@ -72,12 +92,23 @@ public:
     using ExecAll = std::function<void(int16_t, Resource&)>;
     using ExecOne = std::function<int16_t(Resource&)>;
 
+    using Group = std::vector<std::pair<int16_t, Resource*>>;
+    using ExecGroup = std::function<void(Group const&)>;
+
     using CRefPredicate = std::function<bool(Resource const&)>;
     using AfterAllocatedHook = std::function<void(Resource&)>;
 
     using Allocator = std::function<void(void)>;
     using Deallocator = std::function<void(Resource&)>;
 
+    /// How long interrupting calls had to wait for their turn.
+    struct WaitStatistics {
+        uint64_t waits{0};     ///< Calls which had to wait
+        uint64_t timeouts{0};  ///< Calls which gave up waiting
+        std::chrono::microseconds total{0};    ///< Summed up waiting time
+        std::chrono::microseconds longest{0};  ///< Longest waiting time
+    };
+
 private:
     struct ResourceContainer {
         Resource* resource = nullptr;
@@ -93,6 +124,30 @@ private:
     using Iterator = typename ResourceContainerMap::iterator;
     using ConstIterator = typename ResourceContainerMap::const_iterator;
 
+    /// A published copy of the active resources or a resource, no longer
+    /// published since epoch.
+    struct Retired {
+        uint64_t epoch;
+        Group const* snapshot;
+        ResourceContainer container;
+    };
+
+    /// Registers an execution loop with the current epoch for its lifetime,
+    /// which keeps the resources it can see from being reclaimed.
+    class Reader {
+    public:
+        explicit Reader(SharedResource const& owner)
+            : owner_(owner), epoch_(owner._enter()) {}
+        ~Reader(void) { owner_._leave(epoch_); }
+
+        /// The active resources, valid during the lifetime of this Reader.
+        Group const& snapshot(void) const { return *owner_.snapshot_.load(); }
+
+    private:
+        SharedResource const& owner_;
+        uint64_t const epoch_;
+    };
+
 public:
     SharedResource(void)
         : SharedResource(&SharedResource::fallback_executor, this) {}
@@ -109,31 +164,32 @@ public:
         for (auto const& resource : managed_) {
             if (resource.second.resource) delete resource.second.resource;
         }
+
+        // The deallocators might refer to objects already gone by now, so the
+        // retired resources are treated like the managed ones.
+        for (auto const& retired : retired_) {
+            if (retired.snapshot) {
+                delete retired.snapshot;
+            } else if (retired.container.resource) {
+                delete retired.container.resource;
+            }
+        }
+        delete snapshot_.load();
     }
 
     /// Execute a function on all active resources in turn. The parameter is an
     /// optional replacement for the default executor set during construction.
-    /// \param[in] executor The function to be executed on each resource.
-    void exec_all(ExecAll executor) {
-        if (not managed_.size()) {
-            return;
-
-        } else {
-            std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-
-            auto limit = ids_managed_.size();
-            auto id = ids_managed_.cbegin();
-            for (size_t i = 0; i < limit; ++i) {
-                /// but allow execution of an interrupt from exec_one_now()
-                if (interrupt_lock_.test_and_set(std::memory_order_acquire)) {
-                    while (
-                        interrupt_lock_.test_and_set(std::memory_order_acquire))
-                        ;
-                }
-                executor(*id, *(managed_[*id++].resource));
-
-                interrupt_lock_.clear();
-            }
+    /// \param[in] executor The function to be executed on each resource,
+    /// callable like ExecAll.
+    template <typename Executor>
+    void exec_all(Executor executor) {
+        Reader reader(*this);
+
+        for (auto const& entry : reader.snapshot()) {
+            /// but allow execution of an interrupt from exec_one_now()
+            (void)_begin_turn(true);
+            executor(entry.first, *entry.second);
+            _end_turn();
         }
     }
 
@@ -141,34 +197,57 @@ public:
     /// construction.
     void inline exec_all(void) { exec_all(executor_); }
 
-    /// Execute a function on all active resources that satisfy a predicate..
-    /// \param[in] executor The function to be executed on each resource.
-    /// \param[in] predicate A predicate accepting a single resource cref.
-    void exec_if(ExecAll executor, CRefPredicate predicate) {
-        if (not managed_.size()) {
-            return;
+    /// Execute a function on consecutive groups of active resources.  The
+    /// resources are visited in the same order as in exec_all(), but each
+    /// group is handed to the executor at once. A group ends after a resource
+    /// for which ends_group holds, so that only the last resource of a group
+    /// may satisfy ends_group.
+    /// \param[in] ends_group A predicate accepting a single resource cref.
+    /// \param[in] executor The function to be executed on each group,
+    /// callable like ExecGroup.
+    template <typename Executor>
+    void exec_grouped(CRefPredicate ends_group, Executor executor) {
+        Reader reader(*this);
+        auto const& snapshot = reader.snapshot();
+
+        group_.clear();
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+            group_.push_back(snapshot[i]);
+
+            if (not ends_group(*snapshot[i].second) and
+                i + 1 < snapshot.size()) {
+                continue;
+            }
 
-        } else {
-            std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+            /// Allow execution of an interrupt from exec_one_now() between
+            /// groups.
+            (void)_begin_turn(true);
+            executor(group_);
+            _end_turn();
 
-            auto limit = ids_managed_.size();
-            auto id = ids_managed_.cbegin();
-            for (size_t i = 0; i < limit; ++i) {
-                /// Allow interrupting execution of a specific resource.
-                /// \see exec_one_now(), exec_one_now_restarting()
-                while (
-                    interrupt_lock_.test_and_set(std::memory_order_acquire)) {
-                    if (not resume_on_interrupt_) {
-                        return;
-                    }
-                }
-                if (predicate(*(managed_[*id].resource))) {
-                    executor(*id, *(managed_[*id].resource));
-                }
-                id++;
+            group_.clear();
+        }
+    }
 
-                interrupt_lock_.clear();
+    /// Execute a function on all active resources that satisfy a predicate..
+    /// \param[in] executor The function to be executed on each resource,
+    /// callable like ExecAll.
+    /// \param[in] predicate A predicate accepting a single resource cref.
+    template <typename Executor>
+    void exec_if(Executor executor, CRefPredicate predicate) {
+        Reader reader(*this);
+
+        for (auto const& entry : reader.snapshot()) {
+            /// Allow interrupting execution of a specific resource.
+            /// \see exec_one_now(), exec_one_now_restarting()
+            if (not _begin_turn(resume_on_interrupt_)) {
+                return;
+            }
+            if (predicate(*entry.second)) {
+                executor(entry.first, *entry.second);
             }
+
+            _end_turn();
         }
     }
 
@@ -198,6 +277,9 @@ public:
     /// \param[in] id The id of the resource on which executor shall be
     /// executed.
     /// \param[in] executor The function to be executed on each resource.
+    /// \return The result of executor, #TV_INVALID_ID if there is no such
+    /// resource or #TV_BUSY if the loop did not give up its turn within
+    /// interrupt_timeout().
     int16_t exec_one_now(int16_t id, ExecOne executor) const {
         std::shared_lock<std::shared_timed_mutex> lock(mutex_);
 
@@ -215,6 +297,7 @@ public:
     /// \param[in] id The id of the resource on which executor shall be
     /// executed.
     /// \param[in] executor The function to be executed on each resource.
+    /// \return See exec_one_now().
     int16_t exec_one_now_restarting(int16_t id, ExecOne executor) const {
         std::shared_lock<std::shared_timed_mutex> lock(mutex_);
 
@@ -227,11 +310,29 @@ public:
     }
 
     /// Interrupt the main execution loop (exec_all()) non resuming.
-    void interrupt(void) {
+    /// \return False if the loop did not give up its turn within
+    /// interrupt_timeout().
+    bool interrupt(void) {
         resume_on_interrupt_ = false;
-        while (interrupt_lock_.test_and_set(std::memory_order_acquire))
-            ;
-        interrupt_lock_.clear();
+        if (not _begin_interrupt()) {
+            return false;
+        }
+        _end_interrupt();
+        return true;
+    }
+
+    /// Limit the time exec_one_now() and interrupt() wait for an execution
+    /// loop to finish the resource it is executing.
+    /// \param[in] timeout The limit, 0 to wait as long as it takes.
+    void interrupt_timeout(std::chrono::milliseconds timeout) {
+        interrupt_timeout_ms_ = timeout.count();
+    }
+
+    /// Get the statistics of the waiting of exec_one_now() and interrupt().
+    /// \return A copy of the current values.
+    WaitStatistics wait_statistics(void) const {
+        std::lock_guard<std::mutex> lock(turn_mutex_);
+        return waits_;
     }
 
     /// Evaluate a predicate for each active resource and counts the number of
@@ -256,7 +357,7 @@ public:
     /// \param[in] deallocator Optional function to be called immediately before
     /// this resource is removed.
     bool insert(int16_t id, Resource* module, Deallocator deallocator) {
-        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
         if (exists(managed_, id)) {
             LogWarning("SHARED_RESOURCE", "Double allocate");
@@ -266,10 +367,15 @@ public:
 
         managed_[id] = {module, deallocator};
         ids_managed_.push_back(id);
+        _publish();
         Log("SHARED_RESOURCE", "Inserted ", module->name(), " (", id, ")");
         return true;
     }
 
+    /// Remove a resource.  It will be passed to its deallocator by
+    /// reclaim().
+    /// \param[in] id Identifier of the resource.
+    /// \return False if no such resource is managed.
     bool remove(int16_t id) {
         std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
@@ -279,47 +385,83 @@ public:
             return false;
         }
 
-        if (managed_[id].deallocator) {
-            Log("SHARED_RESOURCE::remove", "Id ", id);
-            managed_[id].deallocator(*managed_[id].resource);
-        }
-
+        Log("SHARED_RESOURCE::remove", "Id ", id);
+        auto const container = managed_[id];
         managed_.erase(id);
         ids_managed_.remove(id);
 
+        _publish();
+        _retire(container);
         return true;
     }
 
     /// Removes each (active) resource for which a given predicate holds.
+    /// The resources will be passed to their deallocator by reclaim().
     /// \param[in] predicate A predicate accepting a single resource cref.
     /// \return The number of resources removed.
     size_t remove_if(std::function<bool(Resource const& resource)> predicate) {
         std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
-        auto count = static_cast<size_t>(0);
+        std::vector<ResourceContainer> removed;
         for (auto it = managed_.cbegin(); it != managed_.cend();) {
 
             if (predicate(resource(it))) {
-                // auto const resource_id = id(it);
-                // garbage_[resource_id] = &resource(it);
+                removed.push_back(it->second);
                 ids_managed_.remove(id(it));
                 managed_.erase(it++);
-                count++;
             } else {
                 ++it;
             }
         }
 
-        return count;
+        if (removed.size()) {
+            _publish();
+            for (auto const& container : removed) {
+                _retire(container);
+            }
+        }
+        return removed.size();
     }
 
+    /// Remove all resources.  They will be passed to their deallocator by
+    /// reclaim().
     void remove_all(void) {
         std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
+        std::vector<ResourceContainer> removed;
+        for (auto const& resource : managed_) {
+            removed.push_back(resource.second);
+        }
         managed_.clear();
         ids_managed_.clear();
+
+        _publish();
+        for (auto const& container : removed) {
+            _retire(container);
+        }
     }
 
+    /// Get the current epoch, to be passed to reclaim().
+    /// \return The epoch.
+    uint64_t epoch(void) const { return epoch_.load(); }
+
+    /// Pass the resources removed before epoch() returned the given value to
+    /// their deallocators, or delete them if there is none, unless an
+    /// execution loop started before their removal is still running.  Those
+    /// will be reclaimed by a later call.  The caller has to make sure that
+    /// no reference to them obtained otherwise is still in use.
+    /// \param[in] epoch A value of epoch(), retrieved when this was known.
+    /// Defaults to all resources removed so far.
+    /// \return The number of resources reclaimed.
+    size_t reclaim(uint64_t epoch = std::numeric_limits<uint64_t>::max()) {
+        std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+        return _reclaim(epoch);
+    }
+
+    /// Check without locking whether anything removed is left to reclaim().
+    /// \return True if reclaim() might release something.
+    bool reclaimable(void) const { return retired_count_.load() != 0; }
+
     /// Check whether a resource is active.
     /// \return True If the resource id is active.
     bool managed(int16_t id) const {
@@ -389,7 +531,7 @@ public:
             return false;
         }
 
-        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
         auto it_second =
             std::find(std::begin(ids_managed_), std::end(ids_managed_), second);
@@ -406,6 +548,7 @@ public:
             ++it_first;
         }
         ids_managed_.insert(it_first, second);
+        _publish();
         return true;
     }
 
@@ -414,13 +557,14 @@ public:
     void sort_manually(std::function<void(IdList& ids)> sorter) {
         std::unique_lock<std::shared_timed_mutex> lock(mutex_);
         sorter(ids_managed_);
+        _publish();
     }
 
     /// Get the number of managed objects.
-    /// \return managed_.size()
+    /// \return The size of the published snapshot_.
     size_t size(void) const {
-        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-        return managed_.size();
+        Reader reader(*this);
+        return reader.snapshot().size();
     }
 
     /// Get the id of a managed object.
@@ -470,6 +614,7 @@ public:
             managed_[id] = ResourceContainer();
             managed_[id].resource = new T(id, args...);
             ids_managed_.push_back(id);
+            _publish();
 
         } catch (tv::ConstructionException const& ce) {
             LogError("SHARED_RESOURCE::allocate", ce.what());
@@ -496,18 +641,194 @@ private:
         return map.find(id) != map.end();
     }
 
+    /// Register an execution loop with the current epoch.  If the epoch is
+    /// advanced meanwhile, the registration is repeated for the new one.
+    /// \return The epoch, to be passed to _leave().
+    uint64_t _enter(void) const {
+        while (true) {
+            auto const epoch = epoch_.load();
+            readers_[epoch & 1]++;
+            if (epoch == epoch_.load()) {
+                return epoch;
+            }
+            readers_[epoch & 1]--;
+        }
+    }
+
+    /// Unregister an execution loop registered by _enter().
+    void _leave(uint64_t epoch) const { readers_[epoch & 1]--; }
+
+    /// Advance the epoch, unless a loop registered with the previous one is
+    /// still running, which shares its counter with the next one.  Must be
+    /// called with the unique lock held.
+    /// \return True if advanced.
+    bool _advance(void) {
+        auto const epoch = epoch_.load();
+        if (readers_[(epoch + 1) & 1].load()) {
+            return false;
+        }
+        epoch_ = epoch + 1;
+        return true;
+    }
+
+    /// Publish the current order of the active resources to the execution
+    /// loops and retire the snapshot published before.  Must be called with
+    /// the unique lock held, after each modification.
+    void _publish(void) {
+        auto snapshot = new Group;
+        snapshot->reserve(ids_managed_.size());
+        for (auto id : ids_managed_) {
+            snapshot->emplace_back(id, managed_[id].resource);
+        }
+
+        retired_.push_back(
+            {epoch_.load(), snapshot_.exchange(snapshot), ResourceContainer()});
+        retired_count_ = retired_.size();
+        (void)_reclaim(0);
+    }
+
+    /// Retire a resource, after it has been unpublished.  Must be called with
+    /// the unique lock held.
+    void _retire(ResourceContainer const& container) {
+        retired_.push_back({epoch_.load(), nullptr, container});
+        retired_count_ = retired_.size();
+    }
+
+    /// Release the retired snapshots and the resources retired before epoch,
+    /// if no loop can access them anymore.  This is the case if the epoch was
+    /// advanced twice since they were retired.  Must be called with the
+    /// unique lock held.
+    /// \param[in] epoch Limits the resources released.
+    /// \return The number of resources released.
+    size_t _reclaim(uint64_t epoch) {
+        if (retired_.empty()) {
+            return 0;
+        }
+        (void)(_advance() and _advance());
+
+        auto const current = epoch_.load();
+        auto count = static_cast<size_t>(0);
+        for (auto it = retired_.begin(); it != retired_.end();) {
+            if (it->epoch + 2 > current or
+                (not it->snapshot and it->epoch >= epoch)) {
+                ++it;
+                continue;
+            }
+
+            if (it->snapshot) {
+                delete it->snapshot;
+            } else {
+                auto const& container = it->container;
+                if (container.deallocator) {
+                    container.deallocator(*container.resource);
+                } else {
+                    delete container.resource;
+                }
+                count++;
+            }
+            it = retired_.erase(it);
+        }
+        retired_count_ = retired_.size();
+        return count;
+    }
+
+    /// Take the turn to execute resources from a loop, after the waiting
+    /// interrupts.
+    /// \param[in] wait Wait for the turn if it is taken?
+    /// \return False if not waiting and the turn is taken.
+    bool _begin_turn(bool wait) const {
+        std::unique_lock<std::mutex> lock(turn_mutex_);
+
+        auto const free = [this](void) {
+            return not executing_ and not interrupting_ and
+                   not interrupts_waiting_;
+        };
+        if (not free()) {
+            if (not wait) {
+                return false;
+            }
+            turn_changed_.wait(lock, free);
+        }
+
+        executing_ = true;
+        return true;
+    }
+
+    /// Give up the turn taken by _begin_turn().
+    void _end_turn(void) const {
+        {
+            std::lock_guard<std::mutex> lock(turn_mutex_);
+            executing_ = false;
+        }
+        turn_changed_.notify_all();
+    }
+
+    /// Take the turn to execute a resource from outside the loops.  Waits
+    /// at most interrupt_timeout_ms_ and accounts the time waited.
+    /// \return False on timeout.
+    bool _begin_interrupt(void) const {
+        std::unique_lock<std::mutex> lock(turn_mutex_);
+
+        auto const free = [this](void) {
+            return not executing_ and not interrupting_;
+        };
+        if (not free()) {
+            auto const limit = std::chrono::milliseconds(interrupt_timeout_ms_);
+            auto& time = TimeSource::instance();
+            auto const start = time.now();
+
+            interrupts_waiting_++;
+            auto taken = true;
+            if (limit.count()) {
+                taken =
+                    time.wait_until(lock, turn_changed_, start + limit, free);
+            } else {
+                turn_changed_.wait(lock, free);
+            }
+            interrupts_waiting_--;
+
+            auto const waited =
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    time.now() - start);
+            waits_.waits++;
+            waits_.total += waited;
+            waits_.longest = std::max(waits_.longest, waited);
+
+            if (not taken) {
+                waits_.timeouts++;
+                lock.unlock();
+                turn_changed_.notify_all();  // loops wait for the waiting
+                return false;
+            }
+        }
+
+        interrupting_ = true;
+        return true;
+    }
+
+    /// Give up the turn taken by _begin_interrupt().
+    void _end_interrupt(void) const {
+        {
+            std::lock_guard<std::mutex> lock(turn_mutex_);
+            interrupting_ = false;
+        }
+        turn_changed_.notify_all();
+    }
+
     /// Helper for the exec_one_now methods
     int16_t inline exec_one_now_common(int16_t id, ExecOne executor) const {
 
-        auto result = TV_INVALID_ID;
         auto it = managed_.find(id);
+        if (it == managed_.end()) {
+            return TV_INVALID_ID;
+        }
 
-        if (it != managed_.end()) {
-            while (interrupt_lock_.test_and_set(std::memory_order_acquire))
-                ;
-            result = executor(resource(it));
-            interrupt_lock_.clear();
+        if (not _begin_interrupt()) {
+            LogWarning("SHARED_RESOURCE", "Interrupt timed out for ", id);
+            return TV_BUSY;
         }
+        auto const result = executor(resource(it));
+        _end_interrupt();
 
         return result;
     }
@@ -515,13 +836,27 @@ private:
 private:
     ResourceContainerMap managed_;  ///< Active resources
     IdList ids_managed_;            ///< Sorted access to the active resources
+    Group group_;  ///< Reused by exec_grouped(), which is not reentrant
+
+    std::atomic<Group const*> snapshot_{
+        new Group};  ///< Active resources in order, iterated without locking
+    std::vector<Retired> retired_;  ///< Not reclaimed yet, guarded by mutex_
+    std::atomic<size_t> retired_count_{0};  ///< Size of retired_
+    std::atomic<uint64_t> epoch_{0};  ///< Advanced by _advance()
+    std::atomic<uint32_t> mutable readers_[2]{{0}, {0}};  ///< Loops running,
+                                                        /// by epoch parity
 
     std::shared_timed_mutex mutable mutex_;  ///< multiple reads, one write
 
-    std::atomic_flag mutable interrupt_lock_{
-        ATOMIC_FLAG_INIT};  ///< Signal to interrupt execution loops
+    std::mutex mutable turn_mutex_;  ///< Guards the turn and waits_
+    std::condition_variable mutable turn_changed_;  ///< Signals a free turn
+    bool mutable executing_{false};     ///< A loop has the turn
+    bool mutable interrupting_{false};  ///< An interrupt has the turn
+    uint32_t mutable interrupts_waiting_{0};  ///< Served before the loops
+    std::atomic<uint32_t> interrupt_timeout_ms_{0};  ///< 0: no limit
+    WaitStatistics mutable waits_;  ///< Of interrupts, see wait_statistics()
 
-    bool mutable resume_on_interrupt_{
+    std::atomic<bool> mutable resume_on_interrupt_{
         false};  ///< Signal to resume execution on interrupt
 
     ExecAll executor_;  ///< Default executor (for exec_all())
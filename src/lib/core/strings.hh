@@ -38,6 +38,7 @@ private:
 #ifndef DEFAULT_CALL
         {TV_RESULT_BUFFERED, "Result buffered"},
 #endif
+        {TV_MODULE_LOADING, "Module loading"},
         // -11...
         {TV_NOT_IMPLEMENTED, "Not implemented"},
         {TV_INTERNAL_ERROR, "Unknown internal error"},
@@ -56,6 +57,7 @@ private:
         // -41...
         {TV_EXEC_THREAD_FAILURE, "Main thread did not react"},
         {TV_THREAD_RUNNING, "Main thread already running"},
+        {TV_THREAD_PLACEMENT_FAILED, "Thread placement failed"},
         // -51...
         {TV_MODULE_DLOPEN_FAILED, "Module dlopen failed"},
         {TV_MODULE_DLSYM_FAILED, "Module dlsym failed"},
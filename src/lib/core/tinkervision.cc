@@ -31,39 +31,41 @@
 #include <string>
 #include <cstring>
 #include <cassert>
-#include <atomic>
-#include <thread>
+#include <chrono>
 
 #include "api.hh"
+#include "api_worker.hh"
 #include "logger.hh"
 
 extern "C" {
 
 #ifndef DEFAULT_CALL
-static std::atomic_int tv_buffered_result{
-    TV_OK};  ///< If an op takes too long, buffer for the
-             /// result, retrievable with get_buffered_result()
-static std::atomic_flag tv_buffer_flag{
-    ATOMIC_FLAG_INIT};  ///< Used to signal an operation is finished
-
-#define LOW_LATENCY_CALL(code)                                                \
-    tv_buffered_result = TV_RESULT_BUFFERED;                                  \
-    if (tv_buffer_flag.test_and_set()) {                                      \
-        return tv_buffered_result;                                            \
-    }                                                                         \
-    std::thread([&](void) {                                                   \
-        tv_buffered_result.store(code);                                       \
-        tv_buffer_flag.clear();                                               \
-                }).detach();                                                  \
-    bool set(true);                                                           \
-    for (uint8_t i = 0; i < GRAINS and (set = tv_buffer_flag.test_and_set()); \
-         ++i) {                                                               \
-        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY_GRAIN));  \
-    }                                                                         \
-    if (not set) {                                                            \
-        tv_buffer_flag.clear(); /* set in for-loop */                         \
-    }                                                                         \
-    return static_cast<int16_t>(tv_buffered_result.load());
+/// Executes the calls which might take long.  Constructed on first use.
+static tv::ApiWorker& tv_api_worker(void) {
+    static tv::ApiWorker worker;
+    return worker;
+}
+
+static thread_local tv::ApiWorker::Ticket tv_buffered_request{
+    0};  ///< Latest request of this thread which returned TV_RESULT_BUFFERED
+
+/// Execute a call on the tv_api_worker(), waiting up to GRAINS * DELAY_GRAIN
+/// ms for it to complete.
+/// \return The result of call, or #TV_RESULT_BUFFERED if it takes longer.
+static int16_t tv_low_latency_call(tv::ApiWorker::Call call) {
+    tv::ApiWorker::Ticket ticket;
+    int16_t result;
+    auto const timeout = std::chrono::milliseconds(GRAINS * DELAY_GRAIN);
+    if (tv_api_worker().call(call, timeout, ticket, result)) {
+        return result;
+    }
+    tv_buffered_request = ticket;
+    return TV_RESULT_BUFFERED;
+}
+
+/// code is executed on the tv_api_worker(), so it must not refer to the stack
+#define LOW_LATENCY_CALL(code) \
+    return tv_low_latency_call([=](void) -> int16_t { return code; })
 #else
 #define LOW_LATENCY_CALL(code) return code
 #endif
@@ -96,18 +98,34 @@ int16_t tv_latency_test(void) {
 int16_t tv_duration_test(uint16_t milliseconds) {
     tv::Log("Tinkervision::LatencyTest", milliseconds);
     LOW_LATENCY_CALL([&milliseconds](void) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+        tv::TimeSource::instance().sleep_for(
+            std::chrono::milliseconds(milliseconds));
         return TV_OK;
     }());
 }
 
 #ifndef DEFAULT_CALL
-/// Get the buffered result, if available.
+/// Get the buffered result of the calling thread, if available.
 /// \return
 ///    - #TV_RESULT_BUFFERED until the result is available
+///    - #TV_INVALID_ARGUMENT if it has been retrieved already
 ///    - result of the last buffered op else.
 int16_t tv_get_buffered_result(void) {
-    return static_cast<int16_t>(tv_buffered_result.load());
+    return tv_get_request_result(tv_buffered_request);
+}
+
+int16_t tv_buffered_request_id(uint16_t* request) {
+    *request = tv_buffered_request;
+    return TV_OK;
+}
+
+int16_t tv_get_request_result(uint16_t request) {
+    bool done;
+    int16_t result;
+    if (not tv_api_worker().result(request, done, result)) {
+        return TV_INVALID_ARGUMENT;
+    }
+    return done ? result : TV_RESULT_BUFFERED;
 }
 #endif
 
@@ -145,9 +163,7 @@ int16_t tv_quit(void) {
 
 #ifndef DEFAULT_CALL
     // Wait for any running operations to finish
-    while (tv_buffer_flag.test_and_set())
-        ;
-    tv_buffer_flag.clear();
+    tv_api_worker().drain();
 #endif
 
     return tv::get_api().quit();
@@ -163,6 +179,18 @@ int16_t tv_set_framesize(uint16_t width, uint16_t height) {
     return tv::get_api().set_framesize(width, height);
 }
 
+int16_t tv_set_decode_scale(uint8_t scale) {
+    tv::Log("Tinkervision::SetDecodeScale", static_cast<int>(scale));
+    return tv::get_api().set_decode_scale(scale);
+}
+
+int16_t tv_set_capture_region(uint16_t x, uint16_t y, uint16_t width,
+                              uint16_t height) {
+    tv::Log("Tinkervision::SetCaptureRegion", x, " ", y, " ", width, " ",
+            height);
+    return tv::get_api().set_capture_region(x, y, width, height);
+}
+
 int16_t tv_request_frameperiod(uint32_t milliseconds) {
     tv::Log("Tinkervision::RequestFrameperiod", milliseconds);
     return tv::get_api().request_frameperiod(milliseconds);
@@ -174,6 +202,40 @@ int16_t tv_effective_frameperiod(uint32_t* frameperiod) {
     return TV_OK;
 }
 
+int16_t tv_overload_state(uint8_t* level, uint32_t* frametime) {
+    tv::Log("Tinkervision::OverloadState");
+    return tv::get_api().overload_state(*level, *frametime);
+}
+
+int16_t tv_set_thread_placement(char const* role, uint32_t cpus,
+                                uint8_t priority, int8_t nice) {
+    tv::Log("Tinkervision::SetThreadPlacement", role, " ", cpus, " ",
+            priority, " ", nice);
+    return tv::get_api().thread_placement(role, cpus, priority, nice);
+}
+
+int16_t tv_frame_jitter(uint32_t* interval_us, uint32_t* jitter_us) {
+    tv::Log("Tinkervision::FrameJitter");
+    return tv::get_api().frame_jitter(*interval_us, *jitter_us);
+}
+
+int16_t tv_callbacks_dropped(uint32_t* dropped) {
+    tv::Log("Tinkervision::CallbacksDropped");
+    return tv::get_api().callbacks_dropped(*dropped);
+}
+
+int16_t tv_set_executor_wait_limit(uint32_t milliseconds) {
+    tv::Log("Tinkervision::SetExecutorWaitLimit", milliseconds);
+    return tv::get_api().executor_wait_limit(milliseconds);
+}
+
+int16_t tv_executor_waits(uint32_t* waits, uint32_t* timeouts,
+                          uint32_t* average_us, uint32_t* longest_us) {
+    tv::Log("Tinkervision::ExecutorWaits");
+    return tv::get_api().executor_waits(*waits, *timeouts, *average_us,
+                                        *longest_us);
+}
+
 int16_t tv_get_user_paths_prefix(char path[]) {
     tv::Log("Tinkervision::UserGetPathsPrefix:");
     copy_std_string(tv::get_api().user_paths_prefix(), path);
@@ -258,6 +320,15 @@ int16_t tv_library_parameter_describe(char const* libname, uint16_t parameter,
     return err;
 }
 
+int16_t tv_library_parameters_describe(char const* libname,
+                                       TV_ParameterDescription parameters[],
+                                       uint16_t capacity, uint16_t* count) {
+    tv::Log("Tinkervision::LibraryParametersDescribe", libname);
+    *count = 0;
+    return tv::get_api().library_describe_parameters(libname, parameters,
+                                                     capacity, *count);
+}
+
 //
 // MODULE HANDLING FUNCTIONS
 //
@@ -273,6 +344,32 @@ int16_t tv_module_start(char const* name, int8_t* id) {
     return tv::get_api().module_load(name, *id);
 }
 
+int16_t tv_module_start_async(char const* name, int8_t* id) {
+    tv::Log("Tinkervision::ModuleStartAsync", name);
+    return tv::get_api().module_load_async(name, *id);
+}
+
+int16_t tv_modules_start(char const* const names[], uint8_t count,
+                         int8_t ids[]) {
+    tv::Log("Tinkervision::ModulesStart", count);
+    auto result = TV_OK;
+    for (uint8_t i = 0; i < count; ++i) {
+        auto const started =
+            names[i] ? tv::get_api().module_load_async(names[i], ids[i])
+                     : TV_INVALID_ARGUMENT;
+
+        if (result == TV_OK) {  // keep the first failure
+            result = started;
+        }
+    }
+    return result;
+}
+
+int16_t tv_module_load_status(int8_t id) {
+    tv::Log("Tinkervision::ModuleLoadStatus", id);
+    return tv::get_api().module_load_status(id);
+}
+
 int16_t tv_module_stop(int8_t id) {
     tv::Log("Tinkervision::ModuleStop", id);
     LOW_LATENCY_CALL(tv::get_api().module_stop(id));
@@ -341,6 +438,15 @@ int16_t tv_module_enumerate_parameters(int8_t module_id,
                                                      context);
 }
 
+int16_t tv_module_parameters_describe(int8_t module_id,
+                                      TV_ParameterDescription parameters[],
+                                      uint16_t capacity, uint16_t* count) {
+    tv::Log("Tinkervision::ModuleParametersDescribe", module_id);
+    *count = 0;
+    return tv::get_api().module_describe_parameters(module_id, parameters,
+                                                    capacity, *count);
+}
+
 int16_t tv_module_get_numerical_parameter(int8_t module_id,
                                           char const* const parameter,
                                           int32_t* value) {
@@ -356,6 +462,40 @@ int16_t tv_module_set_numerical_parameter(int8_t module_id,
     return tv::get_api().set_parameter(module_id, parameter, value);
 }
 
+int16_t tv_module_set_numerical_parameters(int8_t module_id,
+                                           char const* const parameters[],
+                                           int32_t const values[],
+                                           uint8_t count) {
+    tv::Log("Tinkervision::SetParameters", module_id, " ", count);
+    tv::ModuleWrapper::ParameterBlock block;
+    for (uint8_t i = 0; i < count; ++i) {
+        block.emplace_back(parameters[i], values[i]);
+    }
+    return tv::get_api().set_parameters(module_id, block);
+}
+
+int16_t tv_module_parameter_handle(int8_t module_id,
+                                   char const* const parameter,
+                                   uint16_t* handle) {
+    tv::Log("Tinkervision::ParameterHandle", module_id, " ", parameter);
+    return tv::get_api().parameter_handle(module_id, parameter, *handle);
+}
+
+int16_t tv_module_get_numerical_parameter_by_handle(int8_t module_id,
+                                                    uint16_t handle,
+                                                    int32_t* value) {
+    tv::Log("Tinkervision::GetParameterByHandle", module_id, " ", handle);
+    return tv::get_api().get_parameter(module_id, handle, *value);
+}
+
+int16_t tv_module_set_numerical_parameter_by_handle(int8_t module_id,
+                                                    uint16_t handle,
+                                                    int32_t value) {
+    tv::Log("Tinkervision::SetParameterByHandle", module_id, " ", handle, " ",
+            value);
+    return tv::get_api().set_parameter(module_id, handle, value);
+}
+
 int16_t tv_module_get_string_parameter(int8_t module_id,
                                        char const* const parameter,
                                        char value[]) {
@@ -420,4 +560,21 @@ int16_t tv_callback_libraries_changed_set(TV_LibrariesCallback callback,
             context);
     return tv::get_api().libraries_changed_callback(callback, context);
 }
+
+int16_t tv_callback_overload_set(TV_OverloadCallback callback, void* context) {
+    tv::Log("Tinkervision::OverloadCallback", (void*)callback, " ", context);
+    return tv::get_api().overload_callback(callback, context);
+}
+
+int16_t tv_callback_frame_set(TV_FrameCallback callback, void* context) {
+    tv::Log("Tinkervision::FrameCallback", (void*)callback, " ", context);
+    return tv::get_api().frame_callback(callback, context);
+}
+
+int16_t tv_callback_module_loaded_set(TV_ModuleLoadedCallback callback,
+                                      void* context) {
+    tv::Log("Tinkervision::ModuleLoadedCallback", (void*)callback, " ",
+            context);
+    return tv::get_api().module_loaded_callback(callback, context);
+}
 }
@@ -47,11 +47,32 @@ int16_t tv_duration_test(uint16_t);
 #ifndef DEFAULT_CALL
 /// Get the buffered result, if available. If any operation returns
 /// #TV_RESULT_BUFFERED, this method can be called until anything else is
-/// returned.
+/// returned.  Operations which may take long are executed one after the
+/// other by a worker thread of the library, each as a request with an id.
+/// The result of a request is kept until retrieved, so results are
+/// independent per request and per calling thread.
 /// \return
 ///    - #TV_RESULT_BUFFERED until the result is available
-///    - result of the last buffered op else.
+///    - #TV_INVALID_ARGUMENT if the result has been retrieved already.
+///    - result of the latest operation of the calling thread which returned
+///    #TV_RESULT_BUFFERED else.
 int16_t tv_get_buffered_result(void);
+
+/// Get the id of the latest request of the calling thread which returned
+/// #TV_RESULT_BUFFERED.
+/// \param[out] request The id, to be passed to tv_get_request_result().
+/// \return TV_OK.
+int16_t tv_buffered_request_id(uint16_t* request);
+
+/// Get the result of a request which returned #TV_RESULT_BUFFERED.  Only
+/// the results of the latest such requests are kept.
+/// \param[in] request The id, see tv_buffered_request_id().
+/// \return
+///    - #TV_RESULT_BUFFERED until the result is available
+///    - #TV_INVALID_ARGUMENT if the request is unknown or its result has
+///    been retrieved already.
+///    - result of the request else.
+int16_t tv_get_request_result(uint16_t request);
 #endif
 
 /// Check if a specific camera device is available.
@@ -114,8 +135,9 @@ int16_t tv_quit(void);
 int16_t tv_get_framesize(uint16_t* width, uint16_t* height);
 
 /// Selects a framesize WxH.
-/// This will temporarily stop and restart all active modules.
-/// If the requested framesize is not available, the settings will be
+/// While modules are running, the change is applied between two frames
+/// without stopping them; the next frame passed to the modules has the new
+/// size.  If the requested framesize is not available, the settings will be
 /// restored
 /// to the last valid settings, if any.  If no module is running, the camera
 /// will just be tested.
@@ -124,8 +146,40 @@ int16_t tv_get_framesize(uint16_t* width, uint16_t* height);
 /// \return
 ///   - #TV_OK if the settings are ok.
 ///   - #TV_CAMERA_SETTINGS_FAILED if the settings are ignored.
+///   - #TV_BUSY if the change could not be applied in time.
 int16_t tv_set_framesize(uint16_t width, uint16_t height);
 
+/// Selects the scale applied when the camera delivers compressed (MJPEG)
+/// frames.  Decoding directly into a smaller frame is much cheaper than
+/// decoding the full frame, so this is the fastest way to process large
+/// framesizes at a lower resolution.  The framesize reported by
+/// tv_get_framesize() is the selected framesize divided by scale.
+/// This will temporarily stop and restart all active modules.
+/// Uncompressed frames are not affected.
+/// \param[in] scale Denominator of the scale, one of 1, 2, 4, 8.
+/// \return
+///   - #TV_OK if the scale is set.
+///   - #TV_INVALID_ARGUMENT if the scale is not supported.
+int16_t tv_set_decode_scale(uint8_t scale);
+
+/// Selects a region of the camera frames to be captured.  All modules will
+/// only get to see this region, and tv_get_framesize() reports its size.
+/// Where supported, the camera device crops the frames, else the region is
+/// cut out while the frames are copied from the device.  The region is given
+/// in pixels of the frames as selected with tv_set_framesize() and
+/// tv_set_decode_scale(); for YUYV-frames, x and width are rounded down to
+/// even numbers.  The change is applied like tv_set_framesize().
+/// \param[in] x Left of the region.
+/// \param[in] y Top of the region.
+/// \param[in] width Width of the region. Pass 0 to capture the full frames.
+/// \param[in] height Height of the region.
+/// \return
+///   - #TV_OK if the region is set.
+///   - #TV_CAMERA_SETTINGS_FAILED if the region does not fit the frames.
+///   - #TV_BUSY if the change could not be applied in time.
+int16_t tv_set_capture_region(uint16_t x, uint16_t y, uint16_t width,
+                              uint16_t height);
+
 /// Set the minimum inverse frame frequency. Vision modules registered
 /// and started in the api will be executed sequentially during one
 /// execution loop. The execution latency set here is the minimum
@@ -142,6 +196,85 @@ int16_t tv_request_frameperiod(uint32_t milliseconds);
 /// \return TV_OK.
 int16_t tv_effective_frameperiod(uint32_t* frameperiod);
 
+/// Get the state of the overload control.  If processing a frame repeatedly
+/// takes longer than the interval in which frames are captured, the rate of
+/// each module with a priority below 8 is halved per level, up to level 4.
+/// Modules with a higher priority, like stream by default, always keep their
+/// rate.
+/// \param[out] level The current level, 0 if nothing is shed.
+/// \param[out] frametime The averaged time in milliseconds needed per frame.
+/// \return TV_OK.
+int16_t tv_overload_state(uint8_t* level, uint32_t* frametime);
+
+/// Place the threads of the library on CPUs and set their scheduling policy
+/// to reduce the jitter of frames on loaded systems.  The threads are grouped
+/// by role:
+///   - \c executor: the execution thread running the modules
+///   - \c capture, \c convert: retrieving and converting camera frames
+///   - \c worker: executing independent modules concurrently
+///   - \c async: executing modules asynchronously, see parameter async
+///   - \c callbacks: making the callbacks
+///   - \c api: executing calls which may return #TV_RESULT_BUFFERED
+///   - \c dirwatch: watching the user module path
+///   - \c stream: serving the stream of module stream
+///
+/// Placements can also be configured in the file #THREADS_FILE in the user
+/// paths prefix, which is read whenever the prefix is set. Each line names
+/// a role followed by any of \c cpus=0,2-3, \c fifo=50 and \c nice=-5, as
+/// described for the parameters below.
+/// \see tv_frame_jitter() to judge the effect.
+/// \param[in] role Name of the role.
+/// \param[in] cpus Bitmask of the CPUs the threads may run on, 0 for all.
+/// \param[in] priority 1 to 99 to schedule the threads as SCHED_FIFO with
+/// this real-time priority, which needs the according privileges. 0 for the
+/// default policy SCHED_OTHER.
+/// \param[in] nice Nice level -20 to 19 under SCHED_OTHER. Negative values
+/// need privileges.
+/// \return
+///   - #TV_INVALID_ARGUMENT if a value is out of range.
+///   - #TV_THREAD_PLACEMENT_FAILED if the placement could not be applied to
+///   each running thread of the role. It is applied to new threads anyways.
+///   - #TV_OK else.
+int16_t tv_set_thread_placement(char const* role, uint32_t cpus,
+                                uint8_t priority, int8_t nice);
+
+/// Retrieve the realised interval between two frames reaching the
+/// execution thread and its jitter, i.e. the average deviation from the
+/// interval.  Both are smoothed over the last frames.
+/// \param[out] interval_us Average interval in microseconds.
+/// \param[out] jitter_us Average jitter in microseconds.
+/// \return TV_OK.
+int16_t tv_frame_jitter(uint32_t* interval_us, uint32_t* jitter_us);
+
+/// Retrieve the number of results not passed to a callback, either because
+/// the callbacks did not keep up with the modules and too many results were
+/// pending, or because they were superseded by a later result of a module
+/// with parameter \c coalesce set.
+/// \param[out] dropped Results dropped since the start of the library.
+/// \return TV_OK.
+int16_t tv_callbacks_dropped(uint32_t* dropped);
+
+/// Limit the time calls which act on a module right away, like
+/// tv_module_run_now() or tv_module_remove(), wait for the execution thread
+/// to finish the module it is executing.  The calls wait without using the
+/// cpu and return #TV_BUSY if the limit is exceeded.  The limit defaults to
+/// #EXECUTOR_WAIT_LIMIT_MS.
+/// \param[in] milliseconds The limit, 0 to wait as long as it takes.
+/// \return TV_OK.
+int16_t tv_set_executor_wait_limit(uint32_t milliseconds);
+
+/// Retrieve how long calls which act on a module right away waited for the
+/// execution thread, since the start of the library.
+/// \param[out] waits Number of calls which had to wait.
+/// \param[out] timeouts Number of calls which exceeded the limit set with
+/// tv_set_executor_wait_limit().
+/// \param[out] average_us Average waiting time of the calls which had to
+/// wait, in microseconds.
+/// \param[out] longest_us Longest waiting time in microseconds.
+/// \return TV_OK.
+int16_t tv_executor_waits(uint32_t* waits, uint32_t* timeouts,
+                          uint32_t* average_us, uint32_t* longest_us);
+
 /// Access the currently set user paths prefix.
 /// \see tv_set_user_paths_prefix()
 /// \param[out] path The user defined path.
@@ -241,6 +374,21 @@ int16_t tv_library_parameter_describe(char const* libname, uint16_t parameter,
                                       char name[], uint8_t* type, int32_t* min,
                                       int32_t* max, int32_t* def);
 
+/// Get the properties of all parameters of a library at once, instead of
+/// calling tv_library_parameter_describe() per parameter.  The value of a
+/// description is the default value of the parameter.
+/// \param[in] libname Name of the module, i.e. filename w/o extension.
+/// \param[out] parameters Array receiving the descriptions.
+/// \param[in] capacity Size of the array.
+/// \param[out] count Number of parameters of the library.  If this exceeds
+/// capacity, only the first capacity parameters are described.
+/// \return
+///    - #TV_INVALID_ARGUMENT: The library is not available.
+///    - #TV_OK else
+int16_t tv_library_parameters_describe(char const* libname,
+                                       TV_ParameterDescription parameters[],
+                                       uint16_t capacity, uint16_t* count);
+
 //
 // MODULE HANDLING FUNCTIONS
 //
@@ -267,9 +415,7 @@ int16_t tv_start_idle(void);
 /// \param[out] id On success, the loaded module will be accessible with
 /// this
 /// id.
-/// \todo Add method to enable parallel module start instead of currently
-/// fixed
-/// sequential.
+/// \see tv_module_start_async() to not wait for the module.
 /// \return
 ///    - #TV_INTERNAL_ERROR if an id clash occured. This is an open but
 ///      unlikely bug.
@@ -280,6 +426,40 @@ int16_t tv_start_idle(void);
 ///    - #TV_OK fine, module loaded and active.
 int16_t tv_module_start(char const* name, int8_t* id);
 
+/// Start a vision module like tv_module_start(), but return immediately.
+/// The module is loaded and initialized on a thread of its own, so several
+/// modules started this way are loaded in parallel.  The id is assigned
+/// immediately, but the module can only be used once it is loaded, which is
+/// reported by tv_module_load_status() and the callback set with
+/// tv_callback_module_loaded_set().
+/// \param[in] name The name of the requested module.
+/// \param[out] id The id of the module.
+/// \return #TV_OK always.
+int16_t tv_module_start_async(char const* name, int8_t* id);
+
+/// Start several vision modules at once, loading them in parallel.  Returns
+/// immediately, see tv_module_start_async().
+/// \param[in] names The names of the requested modules.
+/// \param[in] count The number of names.
+/// \param[out] ids Receives the id of each module, at the index of its
+/// name.
+/// \return The first failure of starting a module, all others are still
+/// started:
+///    - #TV_INVALID_ARGUMENT if a name is missing, its id is not set.
+///    - #TV_OK if all modules are being loaded.
+int16_t tv_modules_start(char const* const names[], uint8_t count,
+                         int8_t ids[]);
+
+/// Get the state of a module started with tv_module_start_async() or
+/// tv_modules_start().
+/// \param[in] id The id of the module.
+/// \return
+///    - #TV_MODULE_LOADING while the module is being loaded.
+///    - #TV_INVALID_ID if the module does not exist (anymore).
+///    - #TV_OK if the module is loaded and active.
+///    - An error code of tv_module_start() if loading failed.
+int16_t tv_module_load_status(int8_t id);
+
 /// Disable a module without removing it.
 /// A disabled module won't be executed, but it is still available for
 /// configuration or reactivation. The associated camera will be released if
@@ -359,7 +539,8 @@ int16_t tv_module_remove(int8_t id);
 ///    - #TV_OK else, name will be valid.
 int16_t tv_module_get_name(int8_t id, char name[]);
 
-/// Get the result of the latest execution of a given module.
+/// Get the result of the latest execution of a given module.  This does not
+/// wait for the execution thread, so the result can be polled at any rate.
 /// \param[in] id The module in question.
 /// \param[out] result The latest result of the module, if any.
 /// \todo What else?
@@ -388,12 +569,27 @@ int16_t tv_remove_all_modules(void);
 ///      have
 ///      been passed, the callback receives an id of \c 0 and no further
 ///      callbacks will be received.
-/// \deprecated Use tv_library_parameter_count() and
+/// \deprecated Use tv_module_parameters_describe(),
+/// tv_library_parameter_count() and
 /// tv_library_describe_parameter().
 int16_t tv_module_enumerate_parameters(int8_t module_id,
                                        TV_StringCallback callback,
                                        void* context);
 
+/// Get the properties and current values of all parameters of a module in
+/// one call, including the parameters supported by all modules.
+/// \param[in] module_id The id of the module.
+/// \param[out] parameters Array receiving the descriptions.
+/// \param[in] capacity Size of the array.
+/// \param[out] count Number of parameters of the module.  If this exceeds
+/// capacity, only the first capacity parameters are described.
+/// \return
+///   - #TV_INVALID_ID if no module exists with module_id.
+///   - #TV_OK else.
+int16_t tv_module_parameters_describe(int8_t module_id,
+                                      TV_ParameterDescription parameters[],
+                                      uint16_t capacity, uint16_t* count);
+
 /// Return the current value of a modules parameter.
 /// \param[in] module_id The id of the module in question.
 /// \param[in] parameter Name of the parameter in question.
@@ -408,6 +604,45 @@ int16_t tv_module_get_numerical_parameter(int8_t module_id,
                                           int32_t* value);
 
 /// Parameterize a module.
+/// Besides their own parameters, all modules support these to control their
+/// execution:
+///   - \c period: Execute every n'th frame, 0 disables the execution.
+///   - \c interval_ms: Targeted time in milliseconds between two executions,
+///   0 to execute as often as \c period allows.
+///   - \c rate_hz: Targeted executions per second, the same as
+///   \c interval_ms. Setting one updates the other. Reads 0 for intervals
+///   exceeding one second.
+///   - \c priority: 0 to 10, modules with a higher priority are preferred if
+///   several modules with a targeted interval are due in the same frame.
+///   From 8 on, modules are not shed under overload, see
+///   tv_overload_state().
+///   - \c async: 1 to execute the module on its own thread on the latest
+///   frame available whenever it is done with the previous one, so that it
+///   does not slow down the other modules. 0 to always execute it in turn
+///   with the others. 2 (default) to switch to 1 once the module took longer
+///   than a frame several times in a row. Modules outputting an image are
+///   never executed asynchronously.
+///
+/// Modules producing results additionally support:
+///   - \c callbacks_enabled: 0 to stop passing results to callbacks.
+///   - \c coalesce: 1 (default) to only pass the latest result to the
+///   callback if results arrive faster than the callback returns, 0 to pass
+///   each result. See tv_callbacks_dropped().
+///   - \c on_change: 1 to pass a result only if it differs from the one
+///   passed before, 0 (default) to pass each result.
+///   - \c deadband: 0 (default) to 1000, a result is only passed if its x,
+///   y, width or height differs by more than this from the one passed
+///   before, or its string differs.
+///   - \c min_interval_ms: 0 (default) to 60000, the minimum time between
+///   the frames of two results passed.
+/// These filters also apply to tv_callback_frame_set().
+///
+/// Stateless modules, which analyse each frame on its own and do not output
+/// an image, additionally support:
+///   - \c parallel: 1 (default) to 8, the number of consecutive frames the
+///   module is executed on at once, by as many instances on their own
+///   threads. Above 1, the module is executed asynchronously. Results are
+///   passed to the callback in the order of the frames.
 /// \param[in] module_id Id of the module to be parameterized.
 /// \param[in] parameter name of the parameter to be set.
 /// \param[in] value Value to be set for parameter.
@@ -423,6 +658,73 @@ int16_t tv_module_set_numerical_parameter(int8_t module_id,
                                           char const* const parameter,
                                           int32_t value);
 
+/// Set several numerical parameters of a module at once.  The values are
+/// applied together between two executions of the module, so no execution
+/// sees only some of them, as might happen with several calls of
+/// tv_module_set_numerical_parameter().  Until then, the previous values
+/// are reported.  If any value is invalid, none is set.
+/// \param[in] module_id Id of the module to be parameterized.
+/// \param[in] parameters Names of the parameters to be set.
+/// \param[in] values Value for the parameter at the same index.
+/// \param[in] count Number of parameters.
+/// \return
+///   - #TV_MODULE_NO_SUCH_PARAMETER if the module does not support one of
+///   the parameters.
+///   - #TV_MODULE_ERROR_SETTING_PARAMETER if a parameter is not numerical
+///   or a value is out of range.
+///   - #TV_INVALID_ID if no module exists with module_id
+///   - #TV_OK else.
+int16_t tv_module_set_numerical_parameters(int8_t module_id,
+                                           char const* const parameters[],
+                                           int32_t const values[],
+                                           uint8_t count);
+
+/// Get the handle of a modules parameter.  The handle identifies the
+/// parameter as long as the module is loaded, and can be passed to
+/// tv_module_get_numerical_parameter_by_handle() and
+/// tv_module_set_numerical_parameter_by_handle(), which saves looking up the
+/// name on each call.
+/// \param[in] module_id The id of the module in question.
+/// \param[in] parameter Name of the parameter in question.
+/// \param[out] handle Handle of parameter.
+/// \return
+///   - #TV_INVALID_ID if no module exists with module_id.
+///   - #TV_MODULE_NO_SUCH_PARAMETER if the module does not support
+///   parameter.
+///   - #TV_OK else.
+int16_t tv_module_parameter_handle(int8_t module_id,
+                                   char const* const parameter,
+                                   uint16_t* handle);
+
+/// Return the current value of a modules parameter, identified by its
+/// handle, see tv_module_parameter_handle().
+/// \param[in] module_id The id of the module in question.
+/// \param[in] handle Handle of the parameter in question.
+/// \param[out] value Current value of the parameter.
+/// \return
+///   - #TV_INVALID_ID if no module exists with module_id.
+///   - #TV_MODULE_NO_SUCH_PARAMETER if handle is invalid or the parameter is
+///   not numerical.
+///   - #TV_OK else.
+int16_t tv_module_get_numerical_parameter_by_handle(int8_t module_id,
+                                                    uint16_t handle,
+                                                    int32_t* value);
+
+/// Parameterize a module, like tv_module_set_numerical_parameter(), with a
+/// parameter identified by its handle, see tv_module_parameter_handle().
+/// \param[in] module_id Id of the module to be parameterized.
+/// \param[in] handle Handle of the parameter to be set.
+/// \param[in] value Value to be set for the parameter.
+/// \return
+///   - #TV_MODULE_NO_SUCH_PARAMETER if handle is invalid.
+///   - #TV_MODULE_ERROR_SETTING_PARAMETER if the parameter is not numerical
+///   or value is out of range.
+///   - #TV_INVALID_ID if no module exists with module_id
+///   - #TV_OK else.
+int16_t tv_module_set_numerical_parameter_by_handle(int8_t module_id,
+                                                    uint16_t handle,
+                                                    int32_t value);
+
 int16_t tv_module_get_string_parameter(int8_t module_id,
                                        char const* const parameter,
                                        char value[]);
@@ -465,7 +767,9 @@ int16_t tv_scene_remove(int16_t scene);
 
 /// Set a callback to the result of a specific module.
 /// The given callback will be called after each execution of the specified
-/// module, provided it has produced a result.
+/// module, provided it has produced a result.  Callbacks are made one at a
+/// time from a thread of their own, so that a slow callback does not delay
+/// the execution of modules.
 /// \param[in] id The module.
 /// \param[in] callback The function to be called for each result.
 /// \return
@@ -501,6 +805,42 @@ int16_t tv_callback_enable_default(TV_Callback callback);
 int16_t tv_callback_libraries_changed_set(TV_LibrariesCallback callback,
                                           void* context);
 
+/// Notify the user if the overload control changes its level.
+/// \see tv_overload_state()
+/// \param[in] callback Receives the new level, the averaged time needed per
+/// frame and the time available per frame, both in milliseconds, and
+/// context.  Pass NULL to unregister.
+/// \param[in] context A pointer to something.
+/// \return
+///    - #TV_OK always.
+int16_t tv_callback_overload_set(TV_OverloadCallback callback, void* context);
+
+/// Receive the results of all modules at once, in one call per frame
+/// instead of one call per module and result.  The callback gets an array
+/// of the results produced since the previous call, one per module, each
+/// tagged with the timestamp of the frame analysed and a sequence number
+/// counting the results of the module.  It is called after the modules
+/// executed on a frame, if any of them produced a result.  Results of
+/// modules executed asynchronously are included in the next call.
+/// Callbacks set per module are still made.
+/// \param[in] callback Receives the results, their count and context.  The
+/// array is only valid during the call.  Pass NULL to unregister.
+/// \param[in] context A pointer to something.
+/// \return
+///    - #TV_OK always.
+int16_t tv_callback_frame_set(TV_FrameCallback callback, void* context);
+
+/// Notify the user whenever a module started with tv_module_start_async() or
+/// tv_modules_start() has been loaded, or failed to load.
+/// \param[in] callback Receives the id of the module, the result as
+/// returned by tv_module_load_status() and context.  It is called from the
+/// thread loading the module.  Pass NULL to unregister.
+/// \param[in] context A pointer to something.
+/// \return
+///    - #TV_OK always.
+int16_t tv_callback_module_loaded_set(TV_ModuleLoadedCallback callback,
+                                      void* context);
+
 #ifdef __cplusplus
 }
 #endif
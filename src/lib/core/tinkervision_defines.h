@@ -40,11 +40,36 @@ typedef struct TV_ModuleResult {
     char string[TV_STRING_SIZE];
 } TV_ModuleResult;
 
+/// A result as part of all results delivered for a frame.
+typedef struct TV_FrameResult {
+    int8_t module_id;      ///< The module producing the result
+    uint32_t sequence;     ///< Counts the results of the module, from 1
+    int64_t timestamp_us;  ///< When the frame analysed was grabbed, in
+                           /// microseconds of the monotonic clock
+    TV_ModuleResult result;
+} TV_FrameResult;
+
+/// Description of a parameter of a module or library, including its value.
+typedef struct TV_ParameterDescription {
+    char name[TV_STRING_SIZE];
+    uint8_t type;                 ///< 0 if numerical, 1 if string
+    int32_t min;                  ///< Minimum value of a numerical parameter
+    int32_t max;                  ///< Maximum value of a numerical parameter
+    int32_t value;                ///< Value of a numerical parameter
+    char string[TV_STRING_SIZE];  ///< Value of a string parameter
+} TV_ParameterDescription;
+
 /// General callback applicable for every module that produces a result.
 typedef void (*TV_Callback)(int8_t, TV_ModuleResult result, void*);
+typedef void (*TV_FrameCallback)(TV_FrameResult const* results,
+                                 uint16_t count, void* context);
 typedef void (*TV_StringCallback)(int8_t, char const* string, void* context);
 typedef void (*TV_LibrariesCallback)(char const* name, char const* path,
                                      int8_t status, void* context);
+typedef void (*TV_OverloadCallback)(uint8_t level, uint32_t frametime,
+                                    uint32_t budget, void* context);
+typedef void (*TV_ModuleLoadedCallback)(int8_t id, int16_t result,
+                                        void* context);
 
 #define TV_UNUSED_ID -1
 
@@ -52,6 +77,8 @@ typedef void (*TV_LibrariesCallback)(char const* name, char const* path,
 #define MODULES_FOLDER "lib"      ///< Relative to USER_PREFIX (compiler define)
 #define DATA_FOLDER "data"        ///< Relative to USER_PREFIX (compiler define)
 #define SCRIPTS_FOLDER "scripts"  ///< Relative to USER_PREFIX (compiler define)
+#define THREADS_FILE "threads.conf"  ///< Relative to USER_PREFIX, optional
+#define EXECUTOR_WAIT_LIMIT_MS 1000  ///< See tv_set_executor_wait_limit()
 
 /* result codes */
 
@@ -67,6 +94,9 @@ typedef void (*TV_LibrariesCallback)(char const* name, char const* path,
 #define TV_RESULT_BUFFERED 1
 #endif
 
+///< Special result: The module is still being loaded.
+#define TV_MODULE_LOADING 2
+
 /* General errors: */
 #define TV_NOT_IMPLEMENTED -1
 #define TV_INTERNAL_ERROR -2
@@ -90,6 +120,7 @@ typedef void (*TV_LibrariesCallback)(char const* name, char const* path,
 /* System thread errors: */
 #define TV_EXEC_THREAD_FAILURE -41
 #define TV_THREAD_RUNNING -42
+#define TV_THREAD_PLACEMENT_FAILED -43
 
 /* External library errors: */
 #define TV_MODULE_DLOPEN_FAILED -51
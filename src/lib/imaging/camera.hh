@@ -34,6 +34,18 @@
 
 namespace tv {
 
+/// Rectangular region of a frame, in pixels of the frames as handed out by
+/// a Camera.
+struct FrameRegion {
+    uint16_t x = 0;
+    uint16_t y = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+
+    /// \return True if the region is not empty.
+    operator bool(void) const { return width > 0 and height > 0; }
+};
+
 /// Abstract camera interface used by Tinkervision.
 class Camera {
 public:
@@ -66,9 +78,29 @@ public:
     virtual bool is_open(void) const = 0;
     virtual ColorSpace image_format(void) const = 0;
 
+    /// Get the denominator of the scale applied to the captured frames
+    /// before they are handed out, i.e. the framesize reported by
+    /// get_properties() is the selected framesize divided by this.
+    /// \return 1 if the frames are not scaled, which is the default.
+    virtual uint8_t decode_scale(void) const { return 1; }
+
+    /// Request the device to capture only a region of the frame.  This has to
+    /// be selected before open() and is only a request; check
+    /// region_applied() after opening.
+    /// \param[in] region Region to capture, or an empty region to capture
+    /// the full frame.
+    void select_region(FrameRegion const& region) { region_ = region; }
+
+    /// Check if the device crops the frames to the selected region, in which
+    /// case get_properties() reports the size of the region.
+    /// \return False if the device does not support cropping, which is the
+    /// default.
+    virtual bool region_applied(void) const { return false; }
+
 protected:
     explicit Camera(uint8_t camera_id);
     uint8_t camera_id_;
+    FrameRegion region_{};  ///< Requested with select_region()
 
     virtual bool open_device(void) = 0;
     virtual bool open_device(uint16_t width, uint16_t height) = 0;
@@ -46,16 +46,16 @@ void tv::Convert::operator()(tv::Image const& source, tv::Image& target) {
     size_t bytesize;
     target_format(source.header, width, height, bytesize);
 
-    // Not build for varying ratios of width and height!
+    // Reallocated whenever the framesize changes.
     if (not target.data or bytesize != target.header.bytesize) {
         if (target.data) {
             delete[] target.data;
         }
-        target.header.width = width;
-        target.header.height = height;
         target.header.bytesize = bytesize;
         target.data = new uint8_t[bytesize];
     }
+    target.header.width = width;
+    target.header.height = height;
 
     convert(source, target);
     target.header.timestamp = source.header.timestamp;
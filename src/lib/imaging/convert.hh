@@ -34,6 +34,8 @@
 #include <tuple>
 #include <limits>
 #include <cassert>
+#include <list>
+#include <mutex>
 
 #include "image.hh"
 #include "tinkervision_defines.h"
@@ -464,21 +466,39 @@ public:
     }
 };
 
+/// Provides the current frame in every requested format.  get_frame() may be
+/// called concurrently for the same frame, i.e. by modules being executed in
+/// parallel, while set_frame() must only be called between frames.
 class FrameConversions {
 private:
     Image const* frame_{nullptr};
+    Image const* base_frame_{nullptr};  ///< Frame passed to prepare()
+    std::vector<ColorSpace> requested_;  ///< Formats requested of base_frame_
 
-    using ProvidedFormats = std::vector<Converter>;
+    /// A converter guarded by its own mutex, so that a conversion is run only
+    /// once per frame even if several threads request the same format.
+    struct ProvidedFormat {
+        ProvidedFormat(ColorSpace from, ColorSpace to) : converter(from, to) {}
+
+        Converter converter;
+        std::mutex mutex;
+    };
+
+    /// List instead of vector: the elements are neither copyable nor movable
+    /// and references to them must stay valid while the list grows.
+    using ProvidedFormats = std::list<ProvidedFormat>;
     ProvidedFormats provided_formats_;
+    std::mutex provided_formats_mutex_;  ///< Guards the list, not the elements
 
-    Converter* get_converter(tv::ColorSpace from, tv::ColorSpace to) {
+    ProvidedFormat* get_converter(tv::ColorSpace from, tv::ColorSpace to) {
+        std::lock_guard<std::mutex> lock(provided_formats_mutex_);
 
         auto it =
             std::find_if(provided_formats_.begin(), provided_formats_.end(),
-                         [&](Converter const& converter) {
+                         [&](ProvidedFormat const& provided) {
 
-                return (converter.source_format() == from) and
-                       (converter.target_format() == to);
+                return (provided.converter.source_format() == from) and
+                       (provided.converter.target_format() == to);
             });
 
         if (it == provided_formats_.end()) {
@@ -490,16 +510,45 @@ private:
     }
 
 public:
-    FrameConversions(void) noexcept(noexcept(std::vector<Converter>())) {}
+    FrameConversions(void) noexcept(noexcept(ProvidedFormats())) {}
 
     void set_frame(Image const& image) {
+        std::lock_guard<std::mutex> lock(provided_formats_mutex_);
+
         frame_ = &image;
-        for (auto& converter : provided_formats_) {
+        for (auto& provided : provided_formats_) {
             // signal conversion necessary, see get_frame
-            converter.reset();
+            provided.converter.reset();
         }
     }
 
+    /// Set a new frame and run the conversions into the given formats
+    /// immediately, so that a subsequent get_frame() for one of them does
+    /// not need to convert.  Requests of the same frame are recorded and can
+    /// be retrieved with requested_formats().
+    /// \param[in] image The new frame.
+    /// \param[in] formats The formats to convert image into.
+    void prepare(Image const& image, std::vector<ColorSpace> const& formats) {
+        set_frame(image);
+
+        Image converted;
+        for (auto format : formats) {
+            get_frame(converted, format);
+        }
+
+        std::lock_guard<std::mutex> lock(provided_formats_mutex_);
+        base_frame_ = &image;
+        requested_.clear();
+    }
+
+    /// Get the formats requested of the frame passed to prepare(), excluding
+    /// its own format.
+    /// \param[out] formats The requested formats.
+    void requested_formats(std::vector<ColorSpace>& formats) {
+        std::lock_guard<std::mutex> lock(provided_formats_mutex_);
+        formats = requested_;
+    }
+
     void get_frame(Image& image, tv::ColorSpace format) {
         assert(frame_ and frame_->header.format != ColorSpace::INVALID);
 
@@ -510,6 +559,14 @@ public:
             return;
         }
 
+        if (frame_ == base_frame_) {
+            std::lock_guard<std::mutex> lock(provided_formats_mutex_);
+            if (std::find(requested_.cbegin(), requested_.cend(), format) ==
+                requested_.cend()) {
+                requested_.push_back(format);
+            }
+        }
+
         // Else, check if a converter for the requested format already is
         // instantiated. If not, insert a new one. Else, check if it
         // contains a
@@ -517,16 +574,18 @@ public:
         // run
         // already, just return the result. Else, run the converter.
 
-        auto converter = get_converter(frame_->header.format, format);
-        if (converter) {
-            image = converter->result();
+        auto provided = get_converter(frame_->header.format, format);
+        if (provided) {
+            std::lock_guard<std::mutex> lock(provided->mutex);
+
+            image = provided->converter.result();
 
             if (image.header.format == tv::ColorSpace::INVALID or
                 image.header.timestamp != frame_->header.timestamp) {
 
                 // conversion and flat copy
                 assert(frame_->data);
-                image = (*converter)(*frame_);
+                image = provided->converter(*frame_);
             }
         }
 
@@ -539,14 +598,15 @@ public:
             return frame_->header;
         }
 
-        auto converter = get_converter(frame_->header.format, format);
-        if (not converter) {
+        auto provided = get_converter(frame_->header.format, format);
+        if (not provided) {
             LogError("CAMERACONTROL", "Can't get header for format ", format,
                      " (baseformat: ", frame_->header.format, ")");
             return ImageHeader();
         }
 
-        return converter->convert_header(frame_->header);
+        std::lock_guard<std::mutex> lock(provided->mutex);
+        return provided->converter.convert_header(frame_->header);
     }
 };
 }
@@ -0,0 +1,187 @@
+/// \file jpeg_decoder.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Definition of the MJPEG frame decoder used by the V4L2 camera.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "jpeg_decoder.hh"
+
+#include "logger.hh"
+
+tv::JpegDecoder::JpegDecoder(void) {
+    info_.err = jpeg_std_error(&error_.manager);
+    error_.manager.error_exit = &JpegDecoder::_error_exit;
+    error_.manager.output_message = &JpegDecoder::_output_message;
+    jpeg_create_decompress(&info_);
+}
+
+tv::JpegDecoder::~JpegDecoder(void) { jpeg_destroy_decompress(&info_); }
+
+bool tv::JpegDecoder::set_scale(uint8_t denominator) {
+    if (denominator != 1 and denominator != 2 and denominator != 4 and
+        denominator != 8) {
+        return false;
+    }
+    scale_ = denominator;
+    return true;
+}
+
+void tv::JpegDecoder::target_size(uint16_t width, uint16_t height,
+                                  ColorSpace format, uint16_t& target_width,
+                                  uint16_t& target_height,
+                                  size_t& target_bytesize) const {
+    /// The decoded size is rounded up, the same way libjpeg does it.  Both
+    /// target formats take pixels in pairs, so the last column and row of an
+    /// odd size are dropped then.
+    target_width = _even((width + scale_ - 1) / scale_);
+    target_height = _even((height + scale_ - 1) / scale_);
+
+    auto const pixels = static_cast<size_t>(target_width) * target_height;
+    target_bytesize = (format == ColorSpace::YV12 ? (pixels * 3) >> 1
+                                                  : pixels * 2);
+}
+
+bool tv::JpegDecoder::decode(ImageData const* data, size_t size,
+                             ColorSpace format, uint16_t width,
+                             uint16_t height, ImageData* target) {
+
+    if (format != ColorSpace::YUYV and format != ColorSpace::YV12) {
+        LogError("JPEG_DECODER", "Unsupported target format ", format);
+        return false;
+    }
+
+    /// Any fatal libjpeg error lands here, see _error_exit().
+    if (setjmp(error_.jump_buffer)) {
+        jpeg_abort_decompress(&info_);
+        return false;
+    }
+
+    jpeg_mem_src(&info_, const_cast<unsigned char*>(data), size);
+
+    /// Most webcams send MJPEG frames without Huffman tables, relying on the
+    /// default tables being used, which libjpeg-turbo does.
+    if (jpeg_read_header(&info_, TRUE) != JPEG_HEADER_OK) {
+        jpeg_abort_decompress(&info_);
+        return false;
+    }
+
+    /// Keep the YCbCr samples as they are and choose the fastest settings,
+    /// frames are analysed, not viewed.
+    info_.out_color_space = JCS_YCbCr;
+    info_.scale_num = 1;
+    info_.scale_denom = scale_;
+    info_.dct_method = JDCT_IFAST;
+    info_.do_fancy_upsampling = FALSE;
+    info_.do_block_smoothing = FALSE;
+
+    (void)jpeg_start_decompress(&info_);
+
+    if (_even(info_.output_width) != width or
+        _even(info_.output_height) != height or info_.output_components != 3) {
+        LogWarning("JPEG_DECODER", "Unexpected frame: ", info_.output_width,
+                   "x", info_.output_height, "x", info_.output_components);
+        jpeg_abort_decompress(&info_);
+        return false;
+    }
+
+    row_.resize(static_cast<size_t>(info_.output_width) * 3);
+
+    if (format == ColorSpace::YUYV) {
+        _to_yuyv(target, width, height);
+    } else {
+        _to_yv12(target, width, height);
+    }
+
+    (void)jpeg_finish_decompress(&info_);
+    return true;
+}
+
+void tv::JpegDecoder::_to_yuyv(ImageData* target, uint16_t width,
+                               uint16_t height) {
+    auto row = row_.data();
+    auto to = target;
+
+    // libjpeg insists on all rows being read
+    while (info_.output_scanline < info_.output_height) {
+        auto const scanline = info_.output_scanline;
+        (void)jpeg_read_scanlines(&info_, &row, 1);
+        if (scanline >= height) {
+            continue;
+        }
+
+        // Y Cb Cr Y Cb Cr -> Y U Y V, averaging the chroma of both pixels
+        auto from = row_.data();
+        for (size_t i = 0; i < width; i += 2) {
+            *to++ = from[0];
+            *to++ = (static_cast<int>(from[1]) + from[4]) / 2;
+            *to++ = from[3];
+            *to++ = (static_cast<int>(from[2]) + from[5]) / 2;
+            from += 6;
+        }
+    }
+}
+
+// output is in order y-block, v-block, u-block, see ConvertYUV422ToYUV420
+void tv::JpegDecoder::_to_yv12(ImageData* target, uint16_t width,
+                               uint16_t height) {
+    auto row = row_.data();
+    auto y = target;
+    auto v = target + static_cast<size_t>(width) * height;
+    auto u = v + ((static_cast<size_t>(width) * height) >> 2);
+
+    while (info_.output_scanline < info_.output_height) {
+        auto const scanline = info_.output_scanline;
+        (void)jpeg_read_scanlines(&info_, &row, 1);
+        if (scanline >= height) {
+            continue;
+        }
+        auto const even_row = (scanline % 2) == 0;
+
+        auto from = row_.data();
+        for (size_t i = 0; i < width; i += 2) {
+            *y++ = from[0];
+            *y++ = from[3];
+
+            // Chroma is only sampled from every second row.
+            if (even_row) {
+                *u++ = (static_cast<int>(from[1]) + from[4]) / 2;
+                *v++ = (static_cast<int>(from[2]) + from[5]) / 2;
+            }
+            from += 6;
+        }
+    }
+}
+
+void tv::JpegDecoder::_error_exit(j_common_ptr info) {
+    (*info->err->output_message)(info);
+
+    auto error = reinterpret_cast<ErrorManager*>(info->err);
+    std::longjmp(error->jump_buffer, 1);
+}
+
+void tv::JpegDecoder::_output_message(j_common_ptr info) {
+    char message[JMSG_LENGTH_MAX];
+    (*info->err->format_message)(info, message);
+    LogDebug("JPEG_DECODER", message);
+}
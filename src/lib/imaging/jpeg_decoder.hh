@@ -0,0 +1,116 @@
+/// \file jpeg_decoder.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of the MJPEG frame decoder used by the V4L2 camera.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef JPEG_DECODER_H
+#define JPEG_DECODER_H
+
+#include <cstdio>  // jpeglib.h needs FILE
+#include <csetjmp>
+#include <vector>
+
+#include <jpeglib.h>
+
+#include "image.hh"
+
+namespace tv {
+
+/// Decompress single (M)JPEG frames into one of the uncompressed YCbCr
+/// colorspaces used by Tinkervision.  Decoding is done with libjpeg, which
+/// should be the SIMD-accelerated libjpeg-turbo on the target platform.  The
+/// colorspace conversion of libjpeg is skipped by requesting YCbCr output, so
+/// the decoded samples only have to be reordered into the requested layout.
+/// Optionally, the frame can be downscaled during decoding by 1/2, 1/4 or 1/8,
+/// which is much cheaper than decoding the full frame and scaling it later.
+class JpegDecoder {
+public:
+    JpegDecoder(void);
+    ~JpegDecoder(void);
+
+    JpegDecoder(JpegDecoder const&) = delete;
+    JpegDecoder& operator=(JpegDecoder const&) = delete;
+
+    /// Select the scale denominator used during decoding.
+    /// \param[in] denominator One of 1, 2, 4, 8.
+    /// \return False if the denominator is not supported. The last value is
+    /// kept then.
+    bool set_scale(uint8_t denominator);
+
+    /// Access the scale denominator.
+    /// \return scale_.
+    uint8_t scale(void) const { return scale_; }
+
+    /// Calculate the size of a decoded frame.
+    /// \param[in] width Width of the compressed frame.
+    /// \param[in] height Height of the compressed frame.
+    /// \param[in] format Target format, #ColorSpace::YUYV or #ColorSpace::YV12.
+    /// \param[out] target_width Width of the decoded frame, always even.
+    /// \param[out] target_height Height of the decoded frame, always even.
+    /// \param[out] target_bytesize Bytesize of the decoded frame.
+    void target_size(uint16_t width, uint16_t height, ColorSpace format,
+                     uint16_t& target_width, uint16_t& target_height,
+                     size_t& target_bytesize) const;
+
+    /// Decode a compressed frame.
+    /// \param[in] data Compressed frame.
+    /// \param[in] size Number of valid bytes in data.
+    /// \param[in] format Target format, #ColorSpace::YUYV or #ColorSpace::YV12.
+    /// \param[in] width Expected width of the decoded frame.
+    /// \param[in] height Expected height of the decoded frame.
+    /// \param[out] target Block of at least the size returned by
+    /// target_size().
+    /// \return False if the frame is corrupted or the decoded frame does not
+    /// have the expected dimensions, in which case target is undefined.
+    bool decode(ImageData const* data, size_t size, ColorSpace format,
+                uint16_t width, uint16_t height, ImageData* target);
+
+private:
+    /// libjpeg error manager with a jump target, since libjpeg by default
+    /// calls exit() on fatal errors.
+    struct ErrorManager {
+        jpeg_error_mgr manager;
+        std::jmp_buf jump_buffer;
+    };
+
+    jpeg_decompress_struct info_;
+    ErrorManager error_;
+    uint8_t scale_{1};  ///< Denominator of the decoding scale.
+    std::vector<JSAMPLE> row_;  ///< One decoded row of YCbCr triplets.
+
+    /// Round a dimension down to an even value.
+    static uint16_t _even(unsigned value) {
+        return static_cast<uint16_t>(value & ~1u);
+    }
+
+    void _to_yuyv(ImageData* target, uint16_t width, uint16_t height);
+    void _to_yv12(ImageData* target, uint16_t width, uint16_t height);
+
+    static void _error_exit(j_common_ptr info);
+    static void _output_message(j_common_ptr info);
+};
+}
+
+#endif
@@ -46,9 +46,12 @@ namespace v4l2 {
 static auto TIME_PER_FRAME = V4L2_CAP_TIMEPERFRAME;
 static auto DISCRETE_INTERVAL = V4L2_FRMIVAL_TYPE_DISCRETE;
 static auto PROGRESSIVE = V4L2_FIELD_NONE;
+static auto CROP = V4L2_SEL_TGT_CROP;
+static auto CROP_DEFAULT = V4L2_SEL_TGT_CROP_DEFAULT;
 
 // errors
 static auto INVALID_VALUE = EINVAL;
+static auto NOT_SUPPORTED = ENOTTY;
 
 static Request get_parameter = {VIDIOC_G_PARM, "'get parameter'"};
 static Request set_parameter = {VIDIOC_S_PARM, "'set parameter'"};
@@ -62,6 +65,8 @@ static Request queue_buffers = {VIDIOC_QBUF, "'queue buffers'"};
 static Request stream_on = {VIDIOC_STREAMON, "'stream on'"};
 static Request stream_off = {VIDIOC_STREAMOFF, "'stream off'"};
 static Request query_buffers = {VIDIOC_QUERYBUF, "'query buffers'"};
+static Request get_selection = {VIDIOC_G_SELECTION, "'get selection'"};
+static Request set_selection = {VIDIOC_S_SELECTION, "'set selection'"};
 
 // functions
 static auto mmap = v4l2_mmap;
@@ -70,9 +75,15 @@ static auto open = v4l2_open;
 static auto close = v4l2_close;
 }
 
-tv::V4L2USBCamera::V4L2USBCamera(uint8_t camera_id) : Camera(camera_id) {
+tv::V4L2USBCamera::V4L2USBCamera(uint8_t camera_id, uint8_t decode_scale)
+    : Camera(camera_id) {
     // zero-initialize buffers for the frames to be grabbed
     frames_ = new v4l2::Frame[request_buffer_count_ * sizeof(v4l2::Frame)]();
+
+    if (not decoder_.set_scale(decode_scale)) {
+        LogWarning("V4L2", "Ignoring invalid decode scale ",
+                   static_cast<int>(decode_scale));
+    }
     v4l2_log_file = fopen(v4l2_log, "a");
     if (v4l2_log_file) {
         Log("V4L2", "Opened logfile ", v4l2_log);
@@ -125,11 +136,16 @@ bool tv::V4L2USBCamera::open_device(uint16_t width, uint16_t height) {
     if (device_) {
         auto open = false;
         if (width != 0) {
-            open = _select_requested_settings(width, height) and
-                   _start_capturing();
+            open = _select_requested_settings(width, height);
 
         } else {
-            open = select_best_available_settings() and _start_capturing();
+            open = select_best_available_settings();
+        }
+
+        if (open) {
+            // Not supported by most USB cameras, which is fine.
+            (void)_set_crop();
+            open = _start_capturing();
         }
         if (not open) {
             close();
@@ -160,7 +176,18 @@ void tv::V4L2USBCamera::_retrieve_properties(void) {
         format.type = buffer_type_;
 
         auto result = io_operation(device_, v4l2::get_format, &format);
-        if (result) {
+        if (result and _compressed()) {
+
+            // The properties are those of the decoded frames.
+            uint16_t width, height;
+            decoder_.target_size(format.fmt.pix.width, format.fmt.pix.height,
+                                 image_format(), width, height,
+                                 frame_bytesize_);
+            frame_width_ = width;
+            frame_height_ = height;
+            decoded_.resize(frame_bytesize_);
+
+        } else if (result) {
             frame_width_ = format.fmt.pix.width;
             frame_height_ = format.fmt.pix.height;
             frame_bytesize_ =
@@ -182,8 +209,12 @@ bool tv::V4L2USBCamera::_select_requested_settings(uint16_t width,
             if ((supported_resolutions_[i].width == width) and
                 (supported_resolutions_[i].height == height)) {
 
-                ok = _set_format_and_resolution(
-                    format, 0, i);  // only one format currently
+                for (size_t j = 0; not ok and j < supported_codings_.size();
+                     ++j) {
+                    ok = _set_format_and_resolution(
+                        format, _coding_by_priority(i, j), i);
+                }
+                break;
             }
         }
         if (ok) {
@@ -229,7 +260,9 @@ bool tv::V4L2USBCamera::_set_format_and_resolution(v4l2::Format& format,
     px_format.field = v4l2::PROGRESSIVE;
     px_format.bytesperline = 0;  // lets the driver set it
 
-    if (io_operation(device_, v4l2::set_format, &format)) {
+    // the driver silently substitutes unsupported pixelformats
+    if (io_operation(device_, v4l2::set_format, &format) and
+        px_format.pixelformat == supported_codings_[format_index].v4l2_id) {
 
         coding_ = format_index;
         resolution_ = resolution_index;
@@ -250,14 +283,16 @@ bool tv::V4L2USBCamera::_set_best_format_and_resolution(v4l2::Format& format) {
     resolution_ = -1;
     for (size_t i = 0; i < supported_resolutions_.size(); i++) {
         for (size_t j = 0; j < supported_codings_.size(); j++) {
+            auto const coding = _coding_by_priority(i, j);
             px_format.width = supported_resolutions_[i].width;
             px_format.height = supported_resolutions_[i].height;
-            px_format.pixelformat = supported_codings_[j].v4l2_id;
+            px_format.pixelformat = supported_codings_[coding].v4l2_id;
             px_format.field = v4l2::PROGRESSIVE;
             px_format.bytesperline = 0;  // lets the driver set it
-            if (io_operation(device_, v4l2::set_format, &format)) {
+            if (io_operation(device_, v4l2::set_format, &format) and
+                px_format.pixelformat == supported_codings_[coding].v4l2_id) {
 
-                coding_ = j;
+                coding_ = coding;
                 break;
             }
         }
@@ -278,6 +313,99 @@ bool tv::V4L2USBCamera::_set_best_format_and_resolution(v4l2::Format& format) {
     return resolution_ != -1 and coding_ != -1;
 }
 
+bool tv::V4L2USBCamera::_set_crop(void) {
+    cropping_ = false;
+
+    if (not region_) {
+        return true;
+    }
+
+    // The region is given in pixels of the decoded frames.
+    auto const scale = decode_scale();
+
+    auto const left = int32_t(region_.x * scale);
+    auto const top = int32_t(region_.y * scale);
+    auto const width = uint32_t(region_.width * scale);
+    auto const height = uint32_t(region_.height * scale);
+
+    v4l2::Selection selection;
+    std::memset(&selection, 0, sizeof(selection));
+    selection.type = buffer_type_;
+    selection.target = v4l2::CROP;
+    selection.r.left = left;
+    selection.r.top = top;
+    selection.r.width = width;
+    selection.r.height = height;
+
+    if (not io_operation(device_, v4l2::set_selection, &selection,
+                         v4l2::NOT_SUPPORTED)) {
+        return false;
+    }
+
+    // The driver may have adjusted the rectangle.
+    if (selection.r.left != left or selection.r.top != top or
+        selection.r.width != width or selection.r.height != height) {
+        _reset_crop();
+        return false;
+    }
+
+    // Without changing the format, the driver would scale the region to the
+    // previous framesize.
+    v4l2::Format format;
+    format.type = buffer_type_;
+
+    auto ok = io_operation(device_, v4l2::get_format, &format);
+    if (ok) {
+        auto& px_format = format.fmt.pix;
+        px_format.width = selection.r.width;
+        px_format.height = selection.r.height;
+        px_format.bytesperline = 0;  // lets the driver set it
+
+        ok = io_operation(device_, v4l2::set_format, &format) and
+             px_format.width == selection.r.width and
+             px_format.height == selection.r.height;
+    }
+
+    if (not ok) {
+        _reset_crop();
+        return false;
+    }
+
+    Log("V4L2", "Cropping to ", selection.r.width, "x", selection.r.height,
+        " at ", selection.r.left, ",", selection.r.top);
+    cropping_ = true;
+    return true;
+}
+
+void tv::V4L2USBCamera::_reset_crop(void) {
+    v4l2::Selection selection;
+    std::memset(&selection, 0, sizeof(selection));
+    selection.type = buffer_type_;
+    selection.target = v4l2::CROP_DEFAULT;
+
+    if (io_operation(device_, v4l2::get_selection, &selection)) {
+        selection.target = v4l2::CROP;
+        (void)io_operation(device_, v4l2::set_selection, &selection);
+    }
+
+    // restore the selected format
+    v4l2::Format format;
+    format.type = buffer_type_;
+    (void)_set_format_and_resolution(format, coding_, resolution_);
+}
+
+size_t tv::V4L2USBCamera::_coding_by_priority(size_t resolution_index,
+                                              size_t priority) const {
+
+    // Uncompressed codings come first in supported_codings_. For large
+    // frames, reverse the order to prefer the compressed ones.
+    if (supported_resolutions_[resolution_index].width >=
+        compressed_preferred_width_) {
+        return supported_codings_.size() - 1 - priority;
+    }
+    return priority;
+}
+
 bool tv::V4L2USBCamera::_set_highest_framerate(v4l2::PixelFormat& px_format) {
     // Assumes already selected framesize
 
@@ -368,9 +496,10 @@ bool tv::V4L2USBCamera::retrieve_frame(tv::ImageData** data) {
     FD_ZERO(&fds);
     FD_SET(device_, &fds);
 
-    // device ready?
-    result =
-        (select(device_ + 1, &fds, NULL, NULL, &device_wait_timeout_) != -1);
+    // Sleep until the next frame has arrived.  The timeout is copied since
+    // select() modifies it, which would let later calls return immediately.
+    auto timeout = device_wait_timeout_;
+    result = (select(device_ + 1, &fds, NULL, NULL, &timeout) > 0);
 
     if (result) {
         // Queue last read buffer
@@ -388,7 +517,18 @@ bool tv::V4L2USBCamera::retrieve_frame(tv::ImageData** data) {
         result = io_operation(device_, v4l2::deque_buffers, &buffer_);
     }
 
-    if (result) {
+    if (result and _compressed()) {
+        // Corrupted frames are not uncommon with MJPEG, they are skipped.
+        result = decoder_.decode(
+            static_cast<ImageData const*>(frames_[buffer_.index].start),
+            buffer_.bytesused, image_format(), frame_width_, frame_height_,
+            decoded_.data());
+
+        if (result) {
+            *data = decoded_.data();
+        }
+
+    } else if (result) {
         *data = static_cast<uint8_t*>(frames_[buffer_.index].start);
     }
 
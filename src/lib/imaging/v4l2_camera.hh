@@ -30,6 +30,7 @@
 #ifndef WITH_OPENCV_CAM
 
 #include <array>
+#include <vector>
 
 #include <fcntl.h>
 #include <cerrno>
@@ -46,6 +47,7 @@
 
 // baseclass
 #include "camera.hh"
+#include "jpeg_decoder.hh"
 #include "logger.hh"
 
 // aliases for v4l2 types and functions plus definition of related types
@@ -60,6 +62,7 @@ using Format = v4l2_format;
 using PixelFormat = v4l2_pix_format;
 using FrameIntervalEnum = v4l2_frmivalenum;
 using StreamParameter = v4l2_streamparm;
+using Selection = v4l2_selection;
 using Timeout = struct timeval;
 
 // additional types
@@ -73,7 +76,8 @@ using Frame = struct Frame {
 static v4l2_buf_type BUFFER_TYPE_VIDEO_CAPTURE = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 static auto BUFFER_MEMORY_MMAP = V4L2_MEMORY_MMAP;
 // static auto YV12 = V4L2_PIX_FMT_YVU420;  // planar. Encoder-Accepted.
-static auto YUYV = V4L2_PIX_FMT_YUYV;  // 422, packed
+static auto YUYV = V4L2_PIX_FMT_YUYV;    // 422, packed
+static auto MJPEG = V4L2_PIX_FMT_MJPEG;  // compressed, decoded to YUYV
 
 struct Request {
     long unsigned const value;
@@ -121,11 +125,17 @@ using frame_resolution = struct frame_resolution {
 using ColorSpaceMapping = struct ColorSpaceMapping {
     const unsigned v4l2_id;
     const tv::ColorSpace tv_id;
+    const bool compressed;  ///< Frames have to be decoded to tv_id
 };
 
 class V4L2USBCamera : public Camera {
 public:
-    explicit V4L2USBCamera(uint8_t camera_id);
+    /// Constructor.
+    /// \param[in] camera_id Number of the device, as in /dev/video<id>.
+    /// \param[in] decode_scale Denominator of the scale applied while
+    /// decoding compressed frames, one of 1, 2, 4, 8.  Ignored if the device
+    /// delivers uncompressed frames.
+    explicit V4L2USBCamera(uint8_t camera_id, uint8_t decode_scale = 1);
     ~V4L2USBCamera(void) override final;
 
     bool open_device(void) override final;
@@ -136,6 +146,12 @@ public:
         return supported_codings_[coding_].tv_id;
     }
 
+    uint8_t decode_scale(void) const override final {
+        return _compressed() ? decoder_.scale() : 1;
+    }
+
+    bool region_applied(void) const override final { return cropping_; }
+
     bool select_best_available_settings(void);
 
 protected:
@@ -151,12 +167,18 @@ private:
     char const* v4l2_log = "/dev/null";
 #endif
 
-    std::array<ColorSpaceMapping, 1> supported_codings_ = {{
-        {v4l2::YUYV, ColorSpace::YUYV},
+    std::array<ColorSpaceMapping, 2> supported_codings_ = {{
+        {v4l2::YUYV, ColorSpace::YUYV, false},
+        {v4l2::MJPEG, ColorSpace::YUYV, true},
         // Got no hw supporting this to test it yet
-        //{v4l2::YV12, ColorSpace::YV12},
+        //{v4l2::YV12, ColorSpace::YV12, false},
     }};
 
+    /// From this framewidth on, MJPEG is preferred over uncompressed
+    /// codings: most USB2 cameras deliver only a few uncompressed frames per
+    /// second at these resolutions.
+    static const size_t compressed_preferred_width_ = 1280;
+
     std::array<frame_resolution, 5> supported_resolutions_ = {{
         {"WUXGA", 1920, 1200},   // 16:10
         {"FullHD", 1920, 1080},  // 16:9, 1080p
@@ -192,12 +214,21 @@ private:
     size_t frame_height_ = 0;    ///< resolution height
     size_t frame_bytesize_ = 0;  ///< size of data retrieved per frame
 
+    JpegDecoder decoder_;                ///< Used if _compressed()
+    std::vector<ImageData> decoded_{};  ///< Target of decoder_
+
     int coding_ = -1;       ///< index into supported_codings_
     int resolution_ = -1;   ///< index into supported_resolutions_
     double framerate_ = 0;  ///< not settable currently
     bool running_ = false;  ///< True if capturing frames
+    bool cropping_ = false;  ///< True if the driver crops to region_
 
     // helper
+    bool _compressed(void) const {
+        return coding_ >= 0 and supported_codings_[coding_].compressed;
+    }
+    size_t _coding_by_priority(size_t resolution_index,
+                               size_t priority) const;
     bool _start_capturing(void);
     int _capture_frame_byte_size(void);
     bool _init_request_buffers(void);
@@ -207,6 +238,8 @@ private:
     bool _select_requested_settings(uint16_t width, uint16_t height);
     bool _set_best_format_and_resolution(v4l2::Format& format);
     bool _set_highest_framerate(v4l2::PixelFormat& px_format);
+    bool _set_crop(void);
+    void _reset_crop(void);
     void _retrieve_properties(void);
 
     v4l2::IOControl io_control_;  ///< system ioctl abstraction
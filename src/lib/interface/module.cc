@@ -114,57 +114,106 @@ bool tv::Module::register_parameter_typed(std::string const& name,
         return false;
     }
 
-    parameter_map_.insert({name, new T(name, args...)});
-    parameter_names_.push_back(name);
+    if (parameters_.size() > std::numeric_limits<Parameter::Handle>::max()) {
+        LogError("MODULE", name_, ": Too many parameters ", name);
+        init_error_ = true;
+        return false;
+    }
+
+    auto parameter = new T(name, args...);
+    parameter->handle_ = static_cast<Parameter::Handle>(parameters_.size());
+    parameter_map_.insert({name, parameter});
+    parameters_.push_back(parameter);
+    return true;
+}
+
+bool tv::Module::handle(std::string const& parameter,
+                        Parameter::Handle& handle) const {
+    auto const it = parameter_map_.find(parameter);
+    if (it == parameter_map_.cend()) {
+        return false;
+    }
+
+    handle = it->second->handle();
     return true;
 }
 
 bool tv::Module::set(std::string const& parameter, int32_t value) {
-    return set_parameter(parameter, value);
+    Parameter::Handle number;
+    return handle(parameter, number) and set_parameter(number, value);
 }
 
 bool tv::Module::set(std::string const& parameter, std::string const& value) {
+    Parameter::Handle number;
+    return handle(parameter, number) and set_parameter(number, value);
+}
+
+bool tv::Module::set(Parameter::Handle parameter, int32_t value) {
+    return set_parameter(parameter, value);
+}
+
+bool tv::Module::set(Parameter::Handle parameter, std::string const& value) {
     return set_parameter(parameter, value);
 }
 
 template <typename T>
-bool tv::Module::set_parameter(std::string const& parameter, T const& value) {
-    if (has_parameter(parameter) and parameter_map_[parameter]->set(value)) {
+bool tv::Module::set_parameter(Parameter::Handle parameter, T const& value) {
+    if (parameter < parameters_.size() and parameters_[parameter]->set(value)) {
         value_changed(parameter, value);
         return true;
     }
     return false;
 }
 
+void tv::Module::value_changed(Parameter::Handle parameter, int32_t value) {
+    value_changed(parameters_[parameter]->name(), value);
+}
+
+void tv::Module::value_changed(Parameter::Handle parameter,
+                               std::string const& value) {
+    value_changed(parameters_[parameter]->name(), value);
+}
+
 bool tv::Module::get(std::string const& parameter, int32_t& value) const {
-    return get_parameter(parameter, value);
+    Parameter::Handle number;
+    return handle(parameter, number) and get_parameter(number, value);
 }
 
 bool tv::Module::get(std::string const& parameter, std::string& value) const {
+    Parameter::Handle number;
+    return handle(parameter, number) and get_parameter(number, value);
+}
+
+bool tv::Module::get(Parameter::Handle parameter, int32_t& value) const {
+    return get_parameter(parameter, value);
+}
+
+bool tv::Module::get(Parameter::Handle parameter, std::string& value) const {
     return get_parameter(parameter, value);
 }
 
 template <typename T>
-bool tv::Module::get_parameter(std::string const& parameter, T& value) const {
-    if (not has_parameter(parameter)) {
+bool tv::Module::get_parameter(Parameter::Handle parameter, T& value) const {
+    if (parameter >= parameters_.size()) {
         return false;
     }
 
-    return parameter_map_.at(parameter)->get(value);
+    return parameters_[parameter]->get(value);
 }
 
-size_t tv::Module::parameter_count(void) const { return parameter_map_.size(); }
+size_t tv::Module::parameter_count(void) const { return parameters_.size(); }
 
 tv::Parameter const& tv::Module::get_parameter_by_number(size_t number) const {
     // return last if out-of-range
-    auto name = parameter_names_[std::min(number, parameter_count())];
-    return *parameter_map_.find(name)->second;
+    return *parameters_[std::min(number, parameter_count() - 1)];
 }
 
 tv::ImageHeader tv::Module::get_output_image_header(ImageHeader const& input) {
     return ImageHeader();
 }
 
+bool tv::Module::stateless(void) const { return false; }
+
 tv::Result const& tv::Module::execute(tv::Image const& image) {
     /// If the module declared that it outputs_image(), it will be queried for
     /// the header of the output image first.
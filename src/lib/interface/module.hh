@@ -31,6 +31,7 @@
 #include <unordered_map>
 #include <algorithm>
 #include <functional>
+#include <limits>
 
 #include "image.hh"
 #include "tinkervision_defines.h"
@@ -92,6 +93,15 @@ protected:
     /// \return A valid ImageHeader.
     virtual ImageHeader get_output_image_header(ImageHeader const& input);
 
+    /// Declare whether execute() depends on nothing but the current frame and
+    /// the parameters, i.e. not on previous frames.  Several instances of a
+    /// stateless module which does not output an image can then be executed
+    /// on consecutive frames at once, see the parameter parallel.  This will
+    /// be called once, before initialization.  The default implementation
+    /// returns false.
+    /// \return True if the module keeps no state between frames.
+    virtual bool stateless(void) const;
+
     /// Possibly initialize this module.  This will be called only once after
     /// construction of this module.  The default implementation is empty.
     /// \sa initialize(), which calls this.
@@ -165,6 +175,23 @@ protected:
     virtual void value_changed(std::string const& parameter,
                                std::string const& value) {}
 
+    /// Hook for modules which want to be notified about a numerical parameter
+    /// change, identified by its handle instead of its name.  Handles can be
+    /// resolved once, with handle(), after registering the parameters, which
+    /// saves comparing names on each change.  The default implementation
+    /// calls value_changed() with the name of the parameter.
+    /// \param[in] parameter The handle of the changed parameter.
+    /// \param[in] value New value
+    virtual void value_changed(Parameter::Handle parameter, int32_t value);
+
+    /// Hook for modules which want to be notified about a string parameter
+    /// change, identified by its handle instead of its name.  The default
+    /// implementation calls value_changed() with the name of the parameter.
+    /// \param[in] parameter The handle of the changed parameter.
+    /// \param[in] value New value
+    virtual void value_changed(Parameter::Handle parameter,
+                               std::string const& value);
+
     Environment const& environment;  ///< Environment passed to the constructor
 
 public:
@@ -229,14 +256,49 @@ public:
     /// numerical type.
     bool get(std::string const& parameter, std::string& value) const;
 
+    /// Get the handle of a parameter, which can be used instead of the name
+    /// to set or get the parameter without looking it up.  The handle of a
+    /// parameter does not change during the lifetime of this module.
+    /// \param[in] parameter Name of the parameter.
+    /// \param[out] handle Handle of the parameter, if it exists.
+    /// \return False if the specified parameter is not registered.
+    bool handle(std::string const& parameter, Parameter::Handle& handle) const;
+
+    /// Set the specified parameter to the given value.
+    /// \param[in] parameter Handle of the parameter to set.
+    /// \param[in] value Value of the parameter.
+    /// \return True, if the parameter exists, is numeric, and value is its the
+    /// min/max range
+    bool set(Parameter::Handle parameter, int32_t value);
+
+    /// Set the specified string parameter to the given value.
+    /// \param[in] parameter Handle of the parameter to set.
+    /// \param[in] value Value of the parameter.
+    /// \return True, if the parameter exists and is a string type.
+    bool set(Parameter::Handle parameter, std::string const& value);
+
+    /// Get the value of the specified parameter.
+    /// \param[in] parameter Handle of the parameter to retrieve.
+    /// \param[out] value Current value of the parameter.
+    /// \return False if the specified parameter is not registered or is a
+    /// string type.
+    bool get(Parameter::Handle parameter, int32_t& value) const;
+
+    /// Get the value of the specified parameter.
+    /// \param[in] parameter Handle of the parameter to retrieve.
+    /// \param[out] value Current value of the parameter.
+    /// \return False if the specified parameter is not registered or is a
+    /// numerical type.
+    bool get(Parameter::Handle parameter, std::string& value) const;
+
     /// Get the number of parameters registered for this module.
     /// \return Size of the parameter_map_.
     size_t parameter_count(void) const;
 
-    /// Get a specific parameter by its number in the parameter_map_.
-    /// The parameter names are stored reduntantly in a vector, to
+    /// Get a specific parameter by its number, which is its handle.
+    /// The parameters are stored reduntantly in a vector, to
     /// allow access by number.
-    /// \param[in] number Number in range [0, parameter_count()].
+    /// \param[in] number Number in range [0, parameter_count()).
     /// \return The parameter, if it exists, else the last one.
     Parameter const& get_parameter_by_number(size_t number) const;
 
@@ -287,8 +349,8 @@ private:
 
     std::string const name_;  ///< Name of this module, c'tor parameter.
 
-    ParameterMap parameter_map_;                ///< Available parameters.
-    std::vector<std::string> parameter_names_;  ///< Provides counted access.
+    ParameterMap parameter_map_;           ///< Available parameters.
+    std::vector<Parameter*> parameters_;  ///< Indexed by handle.
 
     ImageAllocator output_image_{"Module"};  ///< Output image, possibly unused.
     ImageHeader
@@ -305,9 +367,9 @@ private:
     template <typename T, typename... Args>
     bool register_parameter_typed(std::string const& name, Args... args);
     template <typename T>
-    bool set_parameter(std::string const& parameter, T const& value);
+    bool set_parameter(Parameter::Handle parameter, T const& value);
     template <typename T>
-    bool get_parameter(std::string const& parameter, T& value) const;
+    bool get_parameter(Parameter::Handle parameter, T& value) const;
 };
 }
 
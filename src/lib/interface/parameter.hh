@@ -47,6 +47,9 @@ class Parameter {
 public:
     enum class Type : uint8_t { Numerical, String };
 
+    /// Number of a parameter within its module, see Module::handle().
+    using Handle = uint16_t;
+
     virtual ~Parameter(void) = default;
 
     /// Return the name of this parameter.
@@ -57,6 +60,10 @@ public:
     /// \return name_.
     Type type(void) const { return type_; }
 
+    /// Return the handle of this parameter, valid once it is registered.
+    /// \return handle_.
+    Handle handle(void) const { return handle_; }
+
     virtual int32_t min(void) const { return 0; }
     virtual int32_t max(void) const { return 0; }
     virtual std::string const& string(void) const { return empty_default_; }
@@ -73,8 +80,11 @@ protected:
     Parameter(Type type, std::string const& name) : type_(type), name_(name) {}
 
 private:
+    friend class Module;  ///< Module assigns the handle.
+
     Type type_;
     std::string name_;
+    Handle handle_{0};
     std::string const empty_default_ = "";
 };
 
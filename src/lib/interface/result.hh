@@ -24,6 +24,13 @@
 /// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
 /// USA.
 
+#ifndef RESULT_H
+#define RESULT_H
+
+#include <string>
+
+#include "tinkervision_defines.h"
+
 namespace tv {
 
 /// Result is the unified possible return value of vision modules.
@@ -50,3 +57,4 @@ struct Result {
     }
 };
 }
+#endif
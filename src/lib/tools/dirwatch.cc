@@ -38,6 +38,7 @@
 
 #include "filesystem.hh"
 #include "logger.hh"
+#include "thread_placement.hh"
 
 Dirwatch::Dirwatch(Callback on_change) : on_change_(on_change) {}
 
@@ -147,6 +148,7 @@ void Dirwatch::add_watched_extension(std::string const& ext) {
 }
 
 void Dirwatch::monitor(void) const {
+    tv::ThreadPlacement::Scope placement("dirwatch");
 
     auto const event_size = sizeof(struct inotify_event);
     // buffer space for 10 events, see man inotify
@@ -0,0 +1,129 @@
+/// \file frame_timer.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Implementation of class FrameTimer.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "frame_timer.hh"
+
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+
+#include "logger.hh"
+
+tv::FrameTimer::FrameTimer(void) {
+    timer_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    event_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (timer_ == -1 or event_ == -1) {
+        LogError("FRAMETIMER", "Creation failed: ", std::strerror(errno));
+    }
+}
+
+tv::FrameTimer::~FrameTimer(void) {
+    if (timer_ != -1) {
+        ::close(timer_);
+    }
+    if (event_ != -1) {
+        ::close(event_);
+    }
+}
+
+void tv::FrameTimer::_arm(uint32_t period_ms) {
+    period_ms_ = period_ms;
+    next_ = TimeSource::instance().now() + std::chrono::milliseconds(period_ms);
+
+    if (timer_ == -1) {
+        return;
+    }
+
+    itimerspec spec;
+    std::memset(&spec, 0, sizeof(spec));
+    spec.it_interval.tv_sec = period_ms / 1000;
+    spec.it_interval.tv_nsec = (period_ms % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;  // all zero disarms the timer
+
+    if (timerfd_settime(timer_, 0, &spec, nullptr) == -1) {
+        LogError("FRAMETIMER", "Arming failed: ", std::strerror(errno));
+    }
+}
+
+bool tv::FrameTimer::wait(uint32_t period_ms) {
+    if (period_ms != period_ms_) {
+        _arm(period_ms);
+    }
+
+    if (not period_ms) {
+        return true;
+    }
+
+    auto& time = TimeSource::instance();
+    if (timer_ == -1 or event_ == -1 or not time.realtime()) {
+        time.sleep_until(next_);
+
+        // missed expirations are consumed at once
+        auto const period = std::chrono::milliseconds(period_ms);
+        auto const now = time.now();
+        next_ += period;
+        if (next_ <= now) {
+            next_ = now + period;
+        }
+        return true;
+    }
+
+    pollfd fds[2];
+    fds[0].fd = timer_;
+    fds[0].events = POLLIN;
+    fds[1].fd = event_;
+    fds[1].events = POLLIN;
+
+    while (poll(fds, 2, -1) == -1) {
+        if (errno != EINTR) {
+            LogError("FRAMETIMER", "Poll failed: ", std::strerror(errno));
+            return false;
+        }
+    }
+
+    uint64_t count;
+    if (fds[1].revents & POLLIN) {
+        (void)::read(event_, &count, sizeof(count));  // resets the eventfd
+        return false;
+    }
+
+    // the number of expirations, i.e. frames lost if greater than one
+    return ::read(timer_, &count, sizeof(count)) == sizeof(count);
+}
+
+void tv::FrameTimer::wake(void) {
+    uint64_t const one = 1;
+    if (event_ != -1) {
+        (void)::write(event_, &one, sizeof(one));
+    }
+}
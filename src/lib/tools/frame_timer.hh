@@ -0,0 +1,74 @@
+/// \file frame_timer.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of class FrameTimer.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef FRAME_TIMER_H
+#define FRAME_TIMER_H
+
+#include <cstdint>
+
+#include "time_source.hh"
+
+namespace tv {
+
+/// Periodic timer throttling the capture of frames, based on a timerfd.
+/// Waiting for the timer can be interrupted from another thread with wake(),
+/// which is signalled through an eventfd.  Both are waited for with poll(),
+/// so the waiting thread sleeps until either one fires.  If the TimeSource is
+/// not the system's, the timer sleeps on it instead, which can't be woken.
+class FrameTimer {
+private:
+    int timer_{-1};          ///< timerfd, CLOCK_MONOTONIC
+    int event_{-1};          ///< eventfd, written by wake()
+    uint32_t period_ms_{0};  ///< Period the timer_ is armed with
+    Timestamp next_;         ///< Next expiration, if sleeping instead
+
+    /// Arm the timer_ to expire each period, or disarm it.
+    /// \param[in] period_ms The period, or 0 to disarm.
+    void _arm(uint32_t period_ms);
+
+public:
+    FrameTimer(void);
+    ~FrameTimer(void);
+
+    FrameTimer(FrameTimer const&) = delete;
+    FrameTimer& operator=(FrameTimer const&) = delete;
+
+    /// Wait for the next expiration of the timer.  If the period differs from
+    /// the one previously passed, the timer is rearmed, i.e. the first
+    /// period starts now.  Expirations missed since the last call are
+    /// consumed at once.
+    /// \param[in] period_ms The period of the timer.  If 0, the timer is
+    /// disarmed and the call returns immediately.
+    /// \return False if the wait was interrupted by wake().
+    bool wait(uint32_t period_ms);
+
+    /// Interrupt a running or the next call of wait().
+    void wake(void);
+};
+}
+
+#endif
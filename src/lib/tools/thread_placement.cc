@@ -0,0 +1,262 @@
+/// \file thread_placement.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Implementation of class ThreadPlacement.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "thread_placement.hh"
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "logger.hh"
+
+namespace {
+
+/// Parse an integer in [min, max].
+bool parse_number(std::string const& text, long min, long max, long& value) {
+    if (text.empty()) {
+        return false;
+    }
+
+    char* end = nullptr;
+    value = std::strtol(text.c_str(), &end, 10);
+    return *end == '\0' and value >= min and value <= max;
+}
+
+/// Parse a list of CPUs like 0,2-3 into a bitmask.
+bool parse_cpus(std::string const& text, uint32_t& cpus) {
+    std::istringstream list(text);
+    std::string item;
+
+    cpus = 0;
+    while (std::getline(list, item, ',')) {
+        auto const dash = item.find('-');
+        long first, last;
+
+        if (dash == std::string::npos) {
+            if (not parse_number(item, 0, 31, first)) {
+                return false;
+            }
+            last = first;
+        } else if (not parse_number(item.substr(0, dash), 0, 31, first) or
+                   not parse_number(item.substr(dash + 1), first, 31, last)) {
+            return false;
+        }
+
+        for (auto cpu = first; cpu <= last; ++cpu) {
+            cpus |= (1u << cpu);
+        }
+    }
+    return cpus != 0;
+}
+}
+
+tv::ThreadPlacement::Scope::Scope(std::string const& role)
+    : role_(role), thread_(static_cast<pid_t>(syscall(SYS_gettid))) {
+
+    auto& placements = ThreadPlacement::instance();
+    std::lock_guard<std::mutex> lock(placements.mutex_);
+
+    placements.threads_.emplace(role_, thread_);
+
+    auto it = placements.placements_.find(role_);
+    if (it != placements.placements_.end()) {
+        (void)placements._apply(thread_, it->second);
+    }
+}
+
+tv::ThreadPlacement::Scope::~Scope(void) {
+    auto& placements = ThreadPlacement::instance();
+    std::lock_guard<std::mutex> lock(placements.mutex_);
+
+    auto range = placements.threads_.equal_range(role_);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == thread_) {
+            placements.threads_.erase(it);
+            break;
+        }
+    }
+}
+
+tv::ThreadPlacement& tv::ThreadPlacement::instance(void) {
+    static ThreadPlacement placement;
+    return placement;
+}
+
+bool tv::ThreadPlacement::place(std::string const& role,
+                                Placement const& placement) {
+    if (role.empty() or placement.priority > 99 or placement.nice < -20 or
+        placement.nice > 19) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    placements_[role] = placement;
+
+    auto result = true;
+    auto range = threads_.equal_range(role);
+    for (auto it = range.first; it != range.second; ++it) {
+        result = _apply(it->second, placement) and result;
+    }
+
+    Log("THREADPLACEMENT", "Placed ", role, ": cpus ", placement.cpus,
+        ", priority ", static_cast<int>(placement.priority), ", nice ",
+        static_cast<int>(placement.nice));
+    return result;
+}
+
+bool tv::ThreadPlacement::placement(std::string const& role,
+                                    Placement& placement) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = placements_.find(role);
+    if (it == placements_.end()) {
+        return false;
+    }
+
+    placement = it->second;
+    return true;
+}
+
+bool tv::ThreadPlacement::load(std::string const& filename) {
+    std::ifstream file(filename);
+    if (not file.is_open()) {  // nothing to be placed
+        return true;
+    }
+
+    Log("THREADPLACEMENT", "Loading ", filename);
+
+    auto result = true;
+    std::string line;
+    for (size_t number = 1; std::getline(file, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t") == std::string::npos) {
+            continue;
+        }
+
+        std::string role;
+        Placement placement;
+        if (not _parse(line, role, placement)) {
+            LogWarning("THREADPLACEMENT", filename, ":", number,
+                       ": Invalid line skipped");
+            result = false;
+            continue;
+        }
+
+        result = place(role, placement) and result;
+    }
+
+    return result;
+}
+
+bool tv::ThreadPlacement::_apply(pid_t thread,
+                                 Placement const& placement) const {
+    auto result = true;
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    auto const count = std::thread::hardware_concurrency();
+    for (unsigned cpu = 0; cpu < (count ? count : CPU_SETSIZE); ++cpu) {
+        if (not placement.cpus or (cpu < 32 and (placement.cpus >> cpu) & 1)) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+
+    if (sched_setaffinity(thread, sizeof(cpus), &cpus) == -1) {
+        LogWarning("THREADPLACEMENT", "Setting the CPUs of ", thread,
+                   " failed: ", std::strerror(errno));
+        result = false;
+    }
+
+    sched_param parameter;
+    std::memset(&parameter, 0, sizeof(parameter));
+    parameter.sched_priority = placement.priority;
+    auto const policy = placement.priority ? SCHED_FIFO : SCHED_OTHER;
+
+    if (sched_setscheduler(thread, policy, &parameter) == -1) {
+        LogWarning("THREADPLACEMENT", "Setting the policy of ", thread,
+                   " failed: ", std::strerror(errno));
+        result = false;
+    }
+
+    if (policy == SCHED_OTHER and
+        setpriority(PRIO_PROCESS, static_cast<id_t>(thread),
+                    placement.nice) == -1) {
+        LogWarning("THREADPLACEMENT", "Setting the nice level of ", thread,
+                   " failed: ", std::strerror(errno));
+        result = false;
+    }
+
+    return result;
+}
+
+bool tv::ThreadPlacement::_parse(std::string const& line, std::string& role,
+                                 Placement& placement) const {
+    std::istringstream settings(line);
+    if (not(settings >> role)) {
+        return false;
+    }
+
+    std::string setting;
+    while (settings >> setting) {
+        auto const equals = setting.find('=');
+        if (equals == std::string::npos) {
+            return false;
+        }
+
+        auto const key = setting.substr(0, equals);
+        auto const value = setting.substr(equals + 1);
+        long number;
+
+        if (key == "cpus") {
+            if (not parse_cpus(value, placement.cpus)) {
+                return false;
+            }
+        } else if (key == "fifo") {
+            if (not parse_number(value, 1, 99, number)) {
+                return false;
+            }
+            placement.priority = static_cast<uint8_t>(number);
+        } else if (key == "nice") {
+            if (not parse_number(value, -20, 19, number)) {
+                return false;
+            }
+            placement.nice = static_cast<int8_t>(number);
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
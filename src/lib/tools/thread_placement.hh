@@ -0,0 +1,132 @@
+/// \file thread_placement.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of class ThreadPlacement.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+#include <map>
+#include <mutex>
+
+namespace tv {
+
+/// Places the threads owned by the library, and by modules, on CPUs and sets
+/// their scheduling policy.  Each thread registers a role for its lifetime
+/// with a Scope; all threads of a role share one Placement.  Roles used by the
+/// library are:
+///   - executor: the mainloop executing the modules
+///   - capture, convert: the stages of the FramePipeline
+///   - worker: threads of the WorkerPool
+///   - async: threads executing modules asynchronously, see AsyncLane
+///   - callbacks: the thread of the CallbackDispatcher
+///   - api: the thread of the ApiWorker
+///   - dirwatch: the inotify thread of Dirwatch
+///   - stream: the event loop of the stream module
+///
+/// Placements are set with place() or load()'ed from a file, each line of
+/// which names a role followed by any of the settings
+///   - cpus=0,2-3: the CPUs allowed
+///   - fifo=50: real-time priority 1..99 under SCHED_FIFO
+///   - nice=-5: nice level -20..19 under SCHED_OTHER
+///
+/// Everything after a # is ignored.  Threads of roles without a placement
+/// keep the defaults.
+class ThreadPlacement {
+public:
+    /// How to run the threads of a role.
+    struct Placement {
+        uint32_t cpus{0};     ///< Bitmask of the CPUs allowed, 0 for all
+        uint8_t priority{0};  ///< 1..99 for SCHED_FIFO, 0 for SCHED_OTHER
+        int8_t nice{0};       ///< -20..19, used with SCHED_OTHER
+    };
+
+    /// Registers the calling thread under a role while in scope, applying
+    /// the placement of the role, if any.
+    class Scope {
+    private:
+        std::string const role_;
+        pid_t const thread_;
+
+    public:
+        explicit Scope(std::string const& role);
+        ~Scope(void);
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+    };
+
+    /// Access the only instance.
+    /// \return The instance.
+    static ThreadPlacement& instance(void);
+
+    /// Set the placement of a role and apply it to the running threads of
+    /// that role.
+    /// \param[in] role Name of the role.
+    /// \param[in] placement The placement.
+    /// \return False if the placement is invalid or could not be applied to
+    /// each running thread, e.g. missing the privileges for SCHED_FIFO.
+    bool place(std::string const& role, Placement const& placement);
+
+    /// Get the placement of a role.
+    /// \param[in] role Name of the role.
+    /// \param[out] placement The placement, if one has been set.
+    /// \return False if no placement has been set for role.
+    bool placement(std::string const& role, Placement& placement) const;
+
+    /// Read placements from a file, see the class description.
+    /// \param[in] filename Path of the file.
+    /// \return False if the file exists but contains invalid lines, which
+    /// are skipped, or a placement could not be applied.
+    bool load(std::string const& filename);
+
+private:
+    std::map<std::string, Placement> placements_;
+    std::multimap<std::string, pid_t> threads_;  ///< Registered, by role
+    mutable std::mutex mutex_;
+
+    ThreadPlacement(void) = default;
+
+    /// Apply a placement to a thread.
+    /// \param[in] thread Id of the thread, as returned by gettid.
+    /// \param[in] placement The placement.
+    /// \return False if anything failed.
+    bool _apply(pid_t thread, Placement const& placement) const;
+
+    /// Parse one line of a file passed to load().
+    /// \param[in] line The line, without comment.
+    /// \param[out] role The role named.
+    /// \param[out] placement The settings.
+    /// \return False if the line is malformed.
+    bool _parse(std::string const& line, std::string& role,
+                Placement& placement) const;
+};
+}
+
+#endif
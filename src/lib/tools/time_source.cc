@@ -0,0 +1,105 @@
+/// \file time_source.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Implementation of the classes TimeSource, SystemTime and VirtualTime.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "time_source.hh"
+
+#include <algorithm>
+#include <thread>
+
+std::atomic<tv::TimeSource*> tv::TimeSource::installed_{nullptr};
+
+tv::TimeSource& tv::TimeSource::instance(void) {
+    static SystemTime system;
+
+    auto source = installed_.load();
+    return source ? *source : system;
+}
+
+void tv::TimeSource::install(TimeSource* source) { installed_ = source; }
+
+void tv::SystemTime::sleep_until(Timestamp until) {
+    std::this_thread::sleep_until(until);
+}
+
+tv::VirtualTime::VirtualTime(bool auto_advance, Timestamp start)
+    : now_(start), auto_advance_(auto_advance) {}
+
+tv::Timestamp tv::VirtualTime::now(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return now_;
+}
+
+void tv::VirtualTime::sleep_until(Timestamp until) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (auto_advance_) {
+        if (until > now_) {
+            now_ = until;
+            lock.unlock();
+            advanced_.notify_all();
+            _notify_waiters();
+        }
+        return;
+    }
+
+    advanced_.wait(lock, [this, until](void) { return now_ >= until; });
+}
+
+void tv::VirtualTime::advance(Clock::duration duration) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        now_ += duration;
+    }
+    advanced_.notify_all();
+    _notify_waiters();
+}
+
+void tv::VirtualTime::_attach(std::mutex& mutex,
+                              std::condition_variable& condition) {
+    std::lock_guard<std::mutex> lock(waiters_mutex_);
+    waiters_.push_back({&mutex, &condition});
+}
+
+void tv::VirtualTime::_detach(std::condition_variable& condition) {
+    std::lock_guard<std::mutex> lock(waiters_mutex_);
+    auto it = std::find_if(waiters_.begin(), waiters_.end(),
+                           [&condition](Waiter const& waiter) {
+        return waiter.condition == &condition;
+    });
+    if (it != waiters_.end()) {
+        waiters_.erase(it);
+    }
+}
+
+void tv::VirtualTime::_notify_waiters(void) {
+    // Detaching waits until all are notified, so all are still valid.
+    std::lock_guard<std::mutex> lock(waiters_mutex_);
+    for (auto const& waiter : waiters_) {
+        std::lock_guard<std::mutex> waiting(*waiter.mutex);
+        waiter.condition->notify_all();
+    }
+}
@@ -0,0 +1,185 @@
+/// \file time_source.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of the classes TimeSource, SystemTime and VirtualTime.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef TIME_SOURCE_H
+#define TIME_SOURCE_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+#include "image.hh"
+
+namespace tv {
+
+/// Source of the current time and of sleeps, used wherever the library
+/// schedules, rate-limits or times out on its own.  By default, this is the
+/// SystemTime.  Tests can install() a VirtualTime instead to run
+/// timing-sensitive behaviour reproducibly and without waiting.
+class TimeSource {
+public:
+    virtual ~TimeSource(void) = default;
+
+    /// Get the current time.
+    /// \return The time, as used for image timestamps.
+    virtual Timestamp now(void) = 0;
+
+    /// Sleep until a point in time, return immediately if it has passed.
+    /// \param[in] until The time to wake up.
+    virtual void sleep_until(Timestamp until) = 0;
+
+    /// Check whether this source follows the system clock, so that timers of
+    /// the operating system can be used instead, e.g. by FrameTimer.
+    /// \return False, which is the default.
+    virtual bool realtime(void) const { return false; }
+
+    /// Sleep for a duration.
+    /// \param[in] duration Time to sleep.
+    void sleep_for(Clock::duration duration) {
+        sleep_until(now() + duration);
+    }
+
+    /// Wait on a condition variable until a predicate holds, at most until a
+    /// deadline of this source.  If the source is not realtime(), it notifies
+    /// the condition variable whenever its time passes, see _attach().
+    /// \param[in] lock Locked, guarding the state checked by predicate.
+    /// \param[in] condition Notified after the state changed.
+    /// \param[in] deadline Time at which to give up.
+    /// \param[in] predicate The condition waited for.
+    /// \return The value of predicate.
+    template <typename Predicate>
+    bool wait_until(std::unique_lock<std::mutex>& lock,
+                    std::condition_variable& condition, Timestamp deadline,
+                    Predicate predicate);
+
+    /// Access the installed source.
+    /// \return The source passed to install(), or the SystemTime.
+    static TimeSource& instance(void);
+
+    /// Replace the time source of the library.  This should happen before
+    /// the first call into the library, since threads already sleeping keep
+    /// using the previous source until they wake up.
+    /// \param[in] source The new source, which has to outlive its use, or
+    /// nullptr to return to the SystemTime.
+    static void install(TimeSource* source);
+
+protected:
+    /// Let the source notify condition while a thread waits on it in
+    /// wait_until(), which is necessary unless realtime().  The notification
+    /// has to be made holding mutex, so that the waiting thread can't miss it
+    /// between checking now() and waiting.  Called without holding mutex.
+    /// \param[in] mutex The mutex the thread waits with.
+    /// \param[in] condition The condition variable waited on.
+    virtual void _attach(std::mutex& mutex,
+                         std::condition_variable& condition) {}
+
+    /// Stop notifying condition, called without holding its mutex.
+    /// \param[in] condition As passed to _attach().
+    virtual void _detach(std::condition_variable& condition) {}
+
+private:
+    static std::atomic<TimeSource*> installed_;
+};
+
+template <typename Predicate>
+bool TimeSource::wait_until(std::unique_lock<std::mutex>& lock,
+                            std::condition_variable& condition,
+                            Timestamp deadline, Predicate predicate) {
+    if (realtime()) {
+        return condition.wait_until(lock, deadline, predicate);
+    }
+
+    lock.unlock();
+    _attach(*lock.mutex(), condition);
+    lock.lock();
+
+    while (not predicate() and now() < deadline) {
+        condition.wait(lock);
+    }
+
+    lock.unlock();
+    _detach(condition);
+    lock.lock();
+    return predicate();
+}
+
+/// The time of the system's steady clock.
+class SystemTime : public TimeSource {
+public:
+    Timestamp now(void) override { return Clock::now(); }
+    void sleep_until(Timestamp until) override;
+    bool realtime(void) const override { return true; }
+};
+
+/// Time which only passes as a test wants it to.  If advancing automatically,
+/// each sleep moves the time forward to its end and returns immediately, so
+/// that threads run without any waits.  Else, sleeping threads block until
+/// advance() moves the time past the end of their sleep.  Threads in
+/// wait_until() are woken each time the time moves, which is why the time
+/// must not be moved while holding the mutex such a thread waits with.
+class VirtualTime : public TimeSource {
+private:
+    Timestamp now_;
+    bool const auto_advance_;
+
+    std::mutex mutex_;
+    std::condition_variable advanced_;
+
+    /// A thread in wait_until().
+    struct Waiter {
+        std::mutex* mutex;
+        std::condition_variable* condition;
+    };
+    std::vector<Waiter> waiters_;
+    std::mutex waiters_mutex_;  ///< Guards waiters_, held while notifying
+
+    /// Wake the threads in wait_until() after the time moved.
+    void _notify_waiters(void);
+
+protected:
+    void _attach(std::mutex& mutex,
+                 std::condition_variable& condition) override;
+    void _detach(std::condition_variable& condition) override;
+
+public:
+    /// Construct the time, starting at start.
+    /// \param[in] auto_advance If true, sleeping advances the time.
+    /// \param[in] start The initial time.
+    explicit VirtualTime(bool auto_advance = true,
+                         Timestamp start = Timestamp());
+
+    Timestamp now(void) override;
+    void sleep_until(Timestamp until) override;
+
+    /// Move the time forward, waking the threads whose sleep ended.
+    /// \param[in] duration The time passing.
+    void advance(Clock::duration duration);
+};
+}
+
+#endif
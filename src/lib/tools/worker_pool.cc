@@ -0,0 +1,168 @@
+/// \file worker_pool.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Implementation of class WorkerPool.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "worker_pool.hh"
+
+#include "logger.hh"
+#include "thread_placement.hh"
+
+thread_local tv::WorkerPool* tv::WorkerPool::current_pool_{nullptr};
+thread_local size_t tv::WorkerPool::current_queue_{0};
+
+tv::WorkerPool::WorkerPool(size_t size) {
+    for (size_t i = 0; i <= size; ++i) {
+        queues_.emplace_back(new Queue);
+    }
+
+    for (size_t i = 1; i <= size; ++i) {
+        workers_.emplace_back(&WorkerPool::_work, this, i);
+    }
+
+    Log("WORKERPOOL", "Started ", size, " worker threads");
+}
+
+tv::WorkerPool::~WorkerPool(void) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    tasks_available_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void tv::WorkerPool::run_all(Tasks const& tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+
+    current_pool_ = this;
+    current_queue_ = 0;
+
+    pending_tasks_ += tasks.size();
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        _push(i % queues_.size(), tasks[i]);
+    }
+
+    while (pending_tasks_) {
+        if (_run_one(0)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        tasks_available_.wait(lock, [this](void) {
+            return pending_tasks_ == 0 or queued_tasks_ > 0;
+        });
+    }
+
+    current_pool_ = nullptr;
+}
+
+void tv::WorkerPool::spawn(Task task) {
+    pending_tasks_++;
+    _push(current_pool_ == this ? current_queue_ : 0, std::move(task));
+}
+
+void tv::WorkerPool::_work(size_t index) {
+    ThreadPlacement::Scope placement("worker");
+    current_pool_ = this;
+    current_queue_ = index;
+
+    while (true) {
+        if (_run_one(index)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        tasks_available_.wait(
+            lock, [this](void) { return stopped_ or queued_tasks_ > 0; });
+
+        if (stopped_) {
+            return;
+        }
+    }
+}
+
+void tv::WorkerPool::_push(size_t index, Task task) {
+    {
+        auto& queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued_tasks_++;
+
+    _notify();
+}
+
+bool tv::WorkerPool::_run_one(size_t index) {
+    Task task;
+
+    for (size_t i = 0; i < queues_.size() and not task; ++i) {
+        auto& queue = *queues_[(index + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty()) {
+            continue;
+        }
+
+        if (i == 0) {  // own queue: newest first, it's likely still cached
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {  // steal the oldest, likely the largest part of the work
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queued_tasks_--;
+    }
+
+    if (not task) {
+        return false;
+    }
+
+    try {
+        task();
+    } catch (...) {
+        LogError("WORKERPOOL", "Task threw an exception");
+    }
+
+    if (--pending_tasks_ == 0) {
+        _notify();
+    }
+
+    return true;
+}
+
+void tv::WorkerPool::_notify(void) {
+    // Changes of the counters are published to waiting threads only after
+    // they released mutex_, so no notification is lost.
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    tasks_available_.notify_all();
+}
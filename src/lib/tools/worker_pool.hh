@@ -0,0 +1,120 @@
+/// \file worker_pool.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of class WorkerPool.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace tv {
+
+/// A fixed number of threads executing batches of tasks.
+/// A batch is passed to run_all(), which distributes the tasks to the workers
+/// and returns only after each task has been run, i.e. the call is a barrier.
+/// Tasks may add further tasks to the running batch with spawn(), which is
+/// useful to traverse trees.  Each thread has its own queue of tasks, working
+/// on the newest task of its own queue first and stealing the oldest task of
+/// another queue if its own is empty.
+/// The calling thread participates in the execution, so a pool of size zero is
+/// valid and runs a batch sequentially.  Tasks must not throw.
+class WorkerPool {
+public:
+    using Task = std::function<void(void)>;
+    using Tasks = std::vector<Task>;
+
+private:
+    /// Tasks queued for one thread.
+    struct Queue {
+        std::deque<Task> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<Queue>> queues_;  ///< [0] is run_all()'s
+
+    std::atomic<size_t> pending_tasks_{0};  ///< Tasks of the batch not done
+    std::atomic<size_t> queued_tasks_{0};   ///< Tasks waiting in any queue
+
+    std::mutex mutex_;  ///< Used to wait for tasks, guards stopped_
+    std::condition_variable tasks_available_;  ///< Signals the counters
+    bool stopped_{false};                      ///< Signal to halt the workers
+
+    static thread_local WorkerPool* current_pool_;  ///< Pool of this thread
+    static thread_local size_t current_queue_;      ///< Index into queues_
+
+    /// Worker thread.
+    /// \param[in] index Index of the queue of this worker.
+    void _work(size_t index);
+
+    /// Queue a task for later execution.
+    /// \param[in] index Index of the queue.
+    /// \param[in] task The task.
+    void _push(size_t index, Task task);
+
+    /// Run a task, preferably from the own queue, else stolen from another.
+    /// \param[in] index Index of the own queue.
+    /// \return False if no task was available.
+    bool _run_one(size_t index);
+
+    /// Wake threads waiting for tasks or the end of a batch.
+    void _notify(void);
+
+public:
+    /// Start the worker threads.
+    /// \param[in] size Number of threads in addition to the calling thread.
+    explicit WorkerPool(size_t size);
+
+    /// Stop and join the worker threads.
+    ~WorkerPool(void);
+
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    /// Get the number of worker threads.
+    /// \return The number of threads running tasks beside the calling thread.
+    size_t size(void) const { return workers_.size(); }
+
+    /// Run a batch of tasks and wait for all of them to be finished,
+    /// including the ones spawn()'ed by them.  Must not be called
+    /// concurrently.
+    /// \param[in] tasks The tasks, executed in unspecified order.
+    void run_all(Tasks const& tasks);
+
+    /// Add a task to the running batch.  Must only be called from a task
+    /// run by this pool.
+    /// \param[in] task The task, executed before run_all() returns.
+    void spawn(Task task);
+};
+}
+#endif
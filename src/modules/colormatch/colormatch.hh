@@ -118,6 +118,10 @@ protected:
     /// area of the specified HSV-value range.
     /// \return true.
     bool produces_result(void) const override final { return true; }
+
+    /// Each frame is analysed on its own.
+    /// \return true.
+    bool stateless(void) const override final { return true; }
 };
 }
 
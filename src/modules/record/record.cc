@@ -0,0 +1,265 @@
+/// \file record.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Definition of the module \c Record.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#include "record.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "filesystem.hh"  // check if set path is correctly
+
+DEFINE_VISION_MODULE(Record)
+
+tv::Record::Record(Environment const& envir) : Module("record", envir) {
+    register_parameter("path", path_, [](std::string const& old_path,
+                                         std::string const& new_path) {
+        return is_directory(new_path);
+    });
+    register_parameter("prefix", prefix_);
+
+    // Both apply to the next file.
+    register_parameter("filesize", 1, 4096, filesize_ >> 20);  // MB
+    register_parameter("buffers", 1, 64, buffer_count_);
+}
+
+tv::Record::~Record(void) { _close(); }
+
+void tv::Record::execute(tv::ImageHeader const& header,
+                         tv::ImageData const* data, tv::ImageHeader const&,
+                         tv::ImageData*) {
+
+    // Continue with a new file
+    if (reopen_.exchange(false)) {
+        _close();
+    }
+
+    if (not file_ and not _open()) {
+        return;
+    }
+
+    Buffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (not free_.empty()) {
+            buffer = free_.back();
+            free_.pop_back();
+        }
+    }
+
+    // The writer can't keep up.
+    if (not buffer) {
+        dropped_++;
+        sequence_++;
+        return;
+    }
+
+    auto& record = buffer->header;
+    record.sequence = sequence_++;
+    record.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                           header.timestamp.time_since_epoch()).count();
+    record.bytesize = header.bytesize;
+    record.width = header.width;
+    record.height = header.height;
+    record.format = static_cast<uint8_t>(header.format);
+
+    buffer->data.assign(data, data + header.bytesize);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_.push_back(buffer);
+    }
+    frame_queued_.notify_one();
+}
+
+tv::Result const& tv::Record::get_result(void) const {
+    result_.x = static_cast<int32_t>(written_);
+    result_.y = static_cast<int32_t>(dropped_);
+    result_.result = filename_;
+    return result_;
+}
+
+void tv::Record::stop(void) { _close(); }
+
+void tv::Record::value_changed(std::string const& parameter,
+                               std::string const& value) {
+
+    // Closing here would race with execute(), which does it instead.
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& target = (parameter == "path" ? path_ : prefix_);
+    target = value;
+    reopen_ = true;
+}
+
+void tv::Record::value_changed(std::string const& parameter, int32_t value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (parameter == "filesize") {
+        filesize_ = static_cast<size_t>(value) << 20;
+    } else if (parameter == "buffers") {
+        buffer_count_ = static_cast<size_t>(value);
+    }
+}
+
+bool tv::Record::_open(void) {
+    static auto counter = uint32_t(0);
+
+    std::string path;
+    std::string prefix;
+    size_t filesize;
+    size_t buffer_count;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path = path_;
+        prefix = prefix_;
+        filesize = filesize_;
+        buffer_count = buffer_count_;
+    }
+
+    filename_ = prefix + "_" + std::to_string(std::time(nullptr)) + "_" +
+                std::to_string(++counter) + ".tvr";
+    auto const fullname = path + "/" + filename_;
+
+    fd_ = ::open(fullname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ == -1) {
+        LogError("RECORD", "Can't open ", fullname, ": ",
+                 std::strerror(errno));
+        return false;
+    }
+
+    // Allocating all blocks now prevents the writer from running out of
+    // space, and from waiting for the filesystem to allocate.
+    auto error = posix_fallocate(fd_, 0, filesize);
+    if (error) {
+        LogError("RECORD", "Can't allocate ", filesize, " bytes for ",
+                 fullname, ": ", std::strerror(error));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    auto map =
+        mmap(nullptr, filesize, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        LogError("RECORD", "Can't map ", fullname, ": ", std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    file_ = static_cast<uint8_t*>(map);
+    offset_ = 0;
+    file_size_ = filesize;
+
+    // The frame data is allocated on first use of each buffer.
+    buffers_ = std::vector<Buffer>(buffer_count);
+    free_.clear();
+    queued_.clear();
+    for (auto& buffer : buffers_) {
+        free_.push_back(&buffer);
+    }
+
+    writing_ = true;
+    writer_ = std::thread(&Record::_write, this);
+
+    Log("RECORD", "Recording to ", fullname);
+    return true;
+}
+
+void tv::Record::_close(void) {
+    if (not file_) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_ = false;
+    }
+    frame_queued_.notify_one();
+    writer_.join();
+
+    munmap(file_, file_size_);
+    file_ = nullptr;
+
+    // Remove the unused, preallocated part.
+    if (ftruncate(fd_, offset_) == -1) {
+        LogError("RECORD", "Can't truncate ", filename_, ": ",
+                 std::strerror(errno));
+    }
+    ::close(fd_);
+    fd_ = -1;
+
+    Log("RECORD", "Closed ", filename_, " after ", written_, " frames, ",
+        dropped_, " dropped");
+}
+
+void tv::Record::_write(void) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto full = false;
+
+    while (true) {
+        frame_queued_.wait(
+            lock, [this](void) { return not writing_ or not queued_.empty(); });
+
+        // Stopped, and all queued frames are written
+        if (queued_.empty()) {
+            break;
+        }
+
+        auto buffer = queued_.front();
+        queued_.pop_front();
+        lock.unlock();
+
+        auto const& record = buffer->header;
+        auto const size = sizeof(RecordHeader) + record.bytesize;
+
+        // Page faults on file_ may block here, which is why this is done in
+        // a thread of its own.
+        if (offset_ + size <= file_size_) {
+            std::memcpy(file_ + offset_, &record, sizeof(RecordHeader));
+            std::copy_n(buffer->data.data(), record.bytesize,
+                        file_ + offset_ + sizeof(RecordHeader));
+            offset_ += size;
+            written_++;
+
+        } else {
+            if (not full) {
+                LogWarning("RECORD", filename_, " is full");
+                full = true;
+            }
+            dropped_++;
+        }
+
+        lock.lock();
+        free_.push_back(buffer);
+    }
+}
@@ -0,0 +1,146 @@
+/// \file record.hh
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Declaration of the module \c Record.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include "module.hh"  // interface
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tv {
+
+/// Header written in front of each frame in a recording.  A recording file
+/// is a sequence of records, each consisting of this header directly
+/// followed by bytesize bytes of raw frame data in the given format.  The
+/// sequence ends with the first header having a bytesize of 0, or at the end
+/// of the file.  All values are stored in host byte order.
+struct RecordHeader {
+    uint64_t sequence;   ///< Number of the frame since recording started
+    int64_t timestamp;   ///< Grab time, microseconds of the steady clock
+    uint32_t bytesize;   ///< Size of the frame data following
+    uint16_t width;      ///< Framewidth
+    uint16_t height;     ///< Frameheight
+    uint8_t format;      ///< Value of the tv::ColorSpace of the frame
+    uint8_t padding[7];  ///< Keeps the frame data 8-byte aligned
+};
+
+/// Record raw frames at camera rate to a preallocated, memory-mapped file.
+/// Frames are copied into a bounded pool of buffers from within execute()
+/// and written to the file from a background thread, so that a slow disk
+/// never stalls the execution of other modules.  If no buffer is free, the
+/// frame is dropped and counted.
+/// The result provides the number of written frames in x, the number of
+/// dropped frames in y, and the name of the current file.
+class Record : public Module {
+
+public:
+    Record(Environment const& envir);
+    ~Record(void) override;
+
+protected:
+    void execute(tv::ImageHeader const& header, tv::ImageData const* data,
+                 tv::ImageHeader const&, tv::ImageData*) override final;
+
+    tv::ColorSpace input_format(void) const override {
+        return tv::ColorSpace::YUYV;
+    }
+
+    tv::Result const& get_result(void) const override final;
+
+    bool has_result(void) const override final {
+        return not filename_.empty();
+    }
+
+    bool produces_result(void) const override final { return true; }
+
+    bool outputs_image(void) const override final { return false; }
+
+    void stop(void) override final;
+
+    void value_changed(std::string const& parameter,
+                       std::string const& value) override final;
+
+    void value_changed(std::string const& parameter,
+                       int32_t value) override final;
+
+private:
+    /// A frame waiting to be written.
+    struct Buffer {
+        RecordHeader header;
+        std::vector<uint8_t> data;
+    };
+
+    // Settings, changed from value_changed() and protected by mutex_
+    std::string path_{"/tmp/"};
+    std::string prefix_{"tv-record"};
+    size_t filesize_{256 << 20};  ///< Size of each preallocated file
+    size_t buffer_count_{8};      ///< Maximum number of queued frames
+
+    /// Set if path or prefix changed, to continue with a new file from
+    /// within the next execute().
+    std::atomic<bool> reopen_{false};
+
+    int fd_{-1};
+    uint8_t* file_{nullptr};  ///< Mapping of the current file
+    size_t file_size_{0};     ///< Size of file_
+    size_t offset_{0};        ///< Write position in file_
+    std::string filename_;
+
+    uint64_t sequence_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    tv::Result mutable result_;
+
+    std::vector<Buffer> buffers_;  ///< The pool, allocated with the file
+    std::vector<Buffer*> free_;    ///< Buffers usable by execute()
+    std::deque<Buffer*> queued_;   ///< Buffers to be written, in order
+    std::mutex mutex_;             ///< Protects free_, queued_, settings
+    std::condition_variable frame_queued_;
+    std::thread writer_;
+    bool writing_{false};  ///< Writer runs while true, protected by mutex_
+
+    /// Create, preallocate and map the next file, start the writer.
+    bool _open(void);
+
+    /// Stop the writer after it wrote all queued frames, truncate the file to
+    /// the written size and unmap it.
+    void _close(void);
+
+    /// Executed by writer_.
+    void _write(void);
+};
+}
+DECLARE_VISION_MODULE(Record)
+
+#endif
@@ -57,7 +57,11 @@ void tv::Snapshot::execute(tv::ImageHeader const& header,
             Log("SNAPSHOT", "Requested ", format_, ", got", header.format);
         }
 
-        if (not image_.data) {
+        // (re)allocate on the first frame and whenever the framesize changes
+        if (not image_.data or image_.header != header) {
+            if (image_.data) {
+                delete[] image_.data;
+            }
             image_.header = header;
             image_.data = new uint8_t[header.bytesize];
         }
@@ -117,6 +121,9 @@ void tv::Snapshot::init(void) {
                                          std::string const& new_path) {
         return is_directory(new_path);
     });
+
+    (void)handle("format", format_handle_);
+    (void)handle("path", path_handle_);
 }
 
 bool tv::Snapshot::format_supported(std::string const& format) const {
@@ -128,9 +135,9 @@ bool tv::Snapshot::format_supported(std::string const& format) const {
     return false;
 }
 
-void tv::Snapshot::value_changed(std::string const& parameter,
+void tv::Snapshot::value_changed(Parameter::Handle parameter,
                                  std::string const& value) {
-    if (parameter == "format") {
+    if (parameter == format_handle_) {
         if (value != format_ and
             (value == "yv12" or format_ == "yv12")) {  // switching from manual
                                                        // write to cv::imwrite
@@ -143,8 +150,8 @@ void tv::Snapshot::value_changed(std::string const& parameter,
         Log("SNAPSHOT", "Selected format: ", format_);
     }
 
-    auto& target =
-        (parameter == "format" ? format_ : parameter == "path" ? path_
-                                                               : prefix_);
+    auto& target = (parameter == format_handle_
+                        ? format_
+                        : parameter == path_handle_ ? path_ : prefix_);
     target = value;
 }
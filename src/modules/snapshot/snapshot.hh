@@ -61,7 +61,7 @@ protected:
 
     bool outputs_image(void) const override final { return false; }
 
-    void value_changed(std::string const& parameter,
+    void value_changed(Parameter::Handle parameter,
                        std::string const& value) override final;
 
 private:
@@ -73,6 +73,9 @@ private:
     std::string prefix_{"tv-snap"};
     std::string format_{"jpg"};
 
+    Parameter::Handle format_handle_{0};  ///< Handle of parameter format
+    Parameter::Handle path_handle_{0};    ///< Handle of parameter path
+
     /// \todo Check if all of these formats are supported on the platform,
     /// probably during make.
     std::array<std::string, 8> supported_formats_{
@@ -29,6 +29,7 @@
 #include <chrono>
 
 #include "tinkervision/exceptions.hh"
+#include "tinkervision/thread_placement.hh"
 
 DEFINE_VISION_MODULE(Stream)
 
@@ -43,6 +44,9 @@ tv::Stream::Stream(Environment const& envir)
             // Only allow the value that will be set from execute()
             return not url_.empty() and (new_value == url_);
         });
+
+    // keep the full rate under overload
+    register_parameter("priority", 0, 10, 10);
 }
 
 void tv::Stream::setup(void) {
@@ -79,6 +83,7 @@ void tv::Stream::execute(tv::ImageHeader const& header,
     if (not subsession_) {
 
         context_.encoder.initialize(header.width, header.height, 10);  // FPS!
+        stream_header_ = header;
 
         subsession_ =
             tv::H264MediaSession::createNew(*usage_environment_, context_);
@@ -87,6 +92,7 @@ void tv::Stream::execute(tv::ImageHeader const& header,
         rtsp_server_->addServerMediaSession(session_);
 
         streamer_ = std::async(std::launch::async, [this](void) {
+            ThreadPlacement::Scope placement("stream");
             task_scheduler_->doEventLoop(&killswitch_);
         });
 
@@ -100,7 +106,13 @@ void tv::Stream::execute(tv::ImageHeader const& header,
         context_.encoder.discard_all();
     }
 
-    /// \todo check for constant frame dimensions
+    // The session is set up for one framesize, frames of another size (after
+    // a framesize switch) are not streamed.
+    if (header != stream_header_) {
+        LogWarning("STREAM", "Framesize changed, skipping frame");
+        return;
+    }
+
     context_.encoder.add_frame(data);
 }
 
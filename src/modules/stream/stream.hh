@@ -80,6 +80,8 @@ private:
 
     char killswitch_ = 0;  ///< signal live555 to stop the event loop
 
+    ImageHeader stream_header_{};  ///< Frames the encoder was set up for
+
     void setup(void);
 };
 }
@@ -133,6 +133,22 @@ int main(int argc, char* argv[]) {
     printf("%d Code %d (%s)\n", max_saturation, result,
            tv_result_string(result));
 
+    /* only report matches which moved by more than a few pixels */
+    result = tv_module_set_numerical_parameter(id, "deadband", 5);
+    printf("Set deadband: Code %d (%s)\n", result, tv_result_string(result));
+
+    /* the same range once more, applied at once between two frames */
+    {
+        char const* const names[] = {"min-hue",        "max-hue",
+                                     "min-value",      "max-value",
+                                     "min-saturation", "max-saturation"};
+        int32_t const values[] = {min_hue,   max_hue,        min_value,
+                                  max_value, min_saturation, max_saturation};
+        result = tv_module_set_numerical_parameters(id, names, values, 6);
+        printf("Set range at once: Code %d (%s)\n", result,
+               tv_result_string(result));
+    }
+
     sleep(2);
 
     tv_get_framesize(&width, &height);
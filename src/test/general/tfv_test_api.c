@@ -29,6 +29,18 @@ void callback(int8_t id, TV_ModuleResult result, void* context) {
            result.width, result.height, result.string);
 }
 
+void frame_callback(TV_FrameResult const* results, uint16_t count,
+                    void* context) {
+    uint16_t i;
+    for (i = 0; i < count; ++i) {
+        printf("Frame callback for module %d (%d, %lldus): %d,%d,%d,%d,%s\n",
+               results[i].module_id, results[i].sequence,
+               (long long)results[i].timestamp_us, results[i].result.x,
+               results[i].result.y, results[i].result.width,
+               results[i].result.height, results[i].result.string);
+    }
+}
+
 void str_callback(int8_t id, char const* string, void* context) {
     int ctx = *(int*)(context), i;
     uint16_t parameters;
@@ -92,6 +104,17 @@ int main(int argc, char* argv[]) {
     uint16_t height = 720;
     char string[TV_STRING_SIZE];
     uint32_t period;
+    uint8_t level;
+    uint32_t interval, jitter, dropped;
+    uint32_t waits, timeouts, average, longest;
+    uint16_t request;
+    char const* libraries[] = {"colormatch", "motiondetect"};
+    int8_t ids[2];
+    TV_ParameterDescription parameters[32];
+    uint16_t count;
+    uint16_t handle;
+    int32_t value;
+    int i;
     struct timeval before, after;
     double duration;
 
@@ -117,7 +140,8 @@ int main(int argc, char* argv[]) {
     printf("DurationTest: %d (%s) -> %f sec\n", result,
            tv_result_string(result), duration);
 
-    while (TV_RESULT_BUFFERED == (result = tv_get_buffered_result()))
+    tv_buffered_request_id(&request);
+    while (TV_RESULT_BUFFERED == (result = tv_get_request_result(request)))
         ;
     gettimeofday(&after, NULL);
     duration = difftime(after.tv_sec, before.tv_sec);
@@ -140,6 +164,10 @@ int main(int argc, char* argv[]) {
     result = tv_callback_enable_default(callback);
     printf("Set callback: Code %d (%s)\n", result, tv_result_string(result));
 
+    result = tv_callback_frame_set(frame_callback, NULL);
+    printf("Set frame callback: Code %d (%s)\n", result,
+           tv_result_string(result));
+
     result = tv_start_idle();
     printf("StartIdle: %d (%s)\n", result, tv_result_string(result));
     sleep(2);
@@ -147,6 +175,19 @@ int main(int argc, char* argv[]) {
     result = tv_effective_frameperiod(&period);
     printf("Current frameperiod: %d (%d)\n", period, result);
 
+    result = tv_overload_state(&level, &period);
+    printf("Overload level %d, frametime %d (%d)\n", level, period, result);
+
+    result = tv_frame_jitter(&interval, &jitter);
+    printf("Frame interval %dus, jitter %dus (%d)\n", interval, jitter, result);
+
+    result = tv_callbacks_dropped(&dropped);
+    printf("Callbacks dropped: %d (%d)\n", dropped, result);
+
+    result = tv_executor_waits(&waits, &timeouts, &average, &longest);
+    printf("Executor waits: %d, %d timed out, %dus average, %dus max (%d)\n",
+           waits, timeouts, average, longest, result);
+
     /*
     period = 500;
     result = tv_request_frameperiod(period);
@@ -184,6 +225,27 @@ int main(int argc, char* argv[]) {
       Starting a module, quitting the api, starting same id again failed.
     */
     colormatch_start(1, 20, 25);
+
+    result = tv_module_parameters_describe(1, parameters, 32, &count);
+    printf("Describe Parameters: %d (%s)\n", result, tv_result_string(result));
+    for (i = 0; i < count && i < 32; ++i) {
+        printf("  %s: %d (%d..%d) %s\n", parameters[i].name,
+               parameters[i].value, parameters[i].min, parameters[i].max,
+               parameters[i].string);
+    }
+
+    /* resolve the name once, then use the handle */
+    result = tv_module_parameter_handle(1, "period", &handle);
+    printf("Handle of period: %d -- %d (%s)\n", handle, result,
+           tv_result_string(result));
+    if (result == TV_OK) {
+        result = tv_module_set_numerical_parameter_by_handle(1, handle, 2);
+        printf("Set period by handle: %d (%s)\n", result,
+               tv_result_string(result));
+        result = tv_module_get_numerical_parameter_by_handle(1, handle, &value);
+        printf("Got period by handle: %d -- %d (%s)\n", value, result,
+               tv_result_string(result));
+    }
     /*
        10-29-2015: Deprecated enumeration
     result = tv_module_parameters_enumerate(1, str_callback, &enum_pars);
@@ -192,6 +254,16 @@ int main(int argc, char* argv[]) {
 
     sleep(3);
 
+    /* load several modules in parallel, without waiting for them */
+    result = tv_modules_start(libraries, 2, ids);
+    printf("ModulesStart: %d (%s)\n", result, tv_result_string(result));
+    for (i = 0; i < 2; ++i) {
+        while (TV_MODULE_LOADING == (result = tv_module_load_status(ids[i])))
+            ;
+        printf("Loaded %s as %d: %d (%s)\n", libraries[i], ids[i], result,
+               tv_result_string(result));
+    }
+
     result = tv_remove_all_modules();
     printf("RemoveAll: %d (%s)\n", result, tv_result_string(result));
     sleep(2);
@@ -241,5 +313,19 @@ int main(int argc, char* argv[]) {
     printf("WxH: %lux%lu\n", (long unsigned)width, (long unsigned)height);
     sleep(2);
 
+    /* Only has an effect if the camera delivers MJPEG at this size */
+    result = tv_set_decode_scale(2);
+    printf("SetDecodeScale: %d (%s)\n", result, tv_result_string(result));
+    result = tv_get_framesize(&width, &height);
+    printf("WxH: %lux%lu\n", (long unsigned)width, (long unsigned)height);
+    sleep(2);
+
+    /* Capture only a horizontal band */
+    result = tv_set_capture_region(0, height / 4, width, height / 2);
+    printf("SetCaptureRegion: %d (%s)\n", result, tv_result_string(result));
+    result = tv_get_framesize(&width, &height);
+    printf("WxH: %lux%lu\n", (long unsigned)width, (long unsigned)height);
+    sleep(2);
+
     return 0;
 }
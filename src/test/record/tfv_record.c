@@ -0,0 +1,56 @@
+/*
+Tinkervision - Vision Library for https://github.com/Tinkerforge/red-brick
+Copyright (C) 2016 philipp.kroos@fh-bielefeld.de
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdio.h>
+#include <unistd.h> /* sleep (posix) */
+#include <time.h>   /* nanosleep (posix) */
+
+#include "tinkervision/tinkervision.h"
+
+int main(int argc, char* argv[]) {
+    int8_t id = 0;
+    TV_ModuleResult m_result;
+
+    int16_t result = tv_module_start("record", &id);
+    printf("Load module record: result %d: %s\n", result,
+           tv_result_string(result));
+
+    result = tv_module_set_numerical_parameter(id, "filesize", 64);
+    printf("Record setting filesize: %d (%s)\n", result,
+           tv_result_string(result));
+
+    result = tv_module_set_string_parameter(id, "path", "/tmp/");
+    printf("Record setting path: %d (%s)\n", result, tv_result_string(result));
+
+    /* Record for some seconds */
+    sleep(5);
+
+    result = tv_module_get_result(id, &m_result);
+    printf("Record result: %d (%s)\n", result, tv_result_string(result));
+    if (result == TV_OK) {
+        printf("Recording to %s: %d frames written, %d dropped\n",
+               m_result.string, m_result.x, m_result.y);
+    }
+
+    /* Closes the file */
+    result = tv_module_stop(id);
+    printf("Stopped record: %d (%s)\n", result, tv_result_string(result));
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+/// \file tfv_test_timesource.cc
+/// \author philipp.kroos@fh-bielefeld.de
+/// \date 2016
+///
+/// \brief Manual test of the FrameTimer, the Scheduler and the
+/// OverloadController, driven by a virtual TimeSource.
+///
+/// This file is part of Tinkervision - Vision Library for Tinkerforge Redbrick
+/// \sa https://github.com/Tinkerforge/red-brick
+///
+/// \copyright
+///
+/// This program is free software; you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License
+/// as published by the Free Software Foundation; either version 2
+/// of the License, or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+/// USA.
+
+#include "time_source.hh"
+#include "frame_timer.hh"
+#include "module_wrapper.hh"
+#include "overload_controller.hh"
+#include "scheduler.hh"
+#include "shared_resource.hh"
+
+#include <iostream>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+
+namespace tv {
+// Needing this to access Environment, which has a private constructor.
+class Api {
+    Environment env;
+
+public:
+    Environment& environment(void) { return env; }
+};
+}
+
+// A module doing nothing, only its schedule is of interest.
+class Idle : public tv::Module {
+public:
+    Idle(tv::Environment const& envir) : tv::Module("idle", envir) {}
+
+    tv::ColorSpace input_format(void) const override {
+        return tv::ColorSpace::YUYV;
+    }
+    bool produces_result(void) const override { return false; }
+    bool outputs_image(void) const override { return false; }
+
+    void execute(tv::ImageHeader const&, tv::ImageData const*,
+                 tv::ImageHeader const&, tv::ImageData*) override {}
+};
+
+tv::Module* create_idle(tv::Environment const& envir) {
+    return new Idle(envir);
+}
+
+void destroy_idle(tv::Module* module) { delete module; }
+
+long milliseconds(tv::Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(duration)
+        .count();
+}
+
+void expect(std::string const& what, long expected, long actual) {
+    std::cout << "--> Expecting " << what << ": " << expected << ", got "
+              << actual << (expected == actual ? "" : " - FAILED")
+              << std::endl;
+}
+
+int main() {
+    tv::VirtualTime time;  // sleeping advances the time
+    tv::TimeSource::install(&time);
+
+    // The FrameTimer sleeps on the TimeSource, so no time passes really.
+    tv::FrameTimer timer;
+    auto const start = time.now();
+    auto const wallclock = tv::Clock::now();
+    for (auto i = 0; i < 3; ++i) {
+        (void)timer.wait(40);
+    }
+    expect("ms passed in three periods of 40ms", 120,
+           milliseconds(time.now() - start));
+    expect("ms really waited", 0, milliseconds(tv::Clock::now() - wallclock));
+
+    // Modules scheduled on one second of frames, at 25 frames per second.
+    tv::Api api;
+    auto& envir = api.environment();
+    tv::SharedResource<tv::ModuleWrapper> modules;
+    std::map<int16_t, std::pair<std::string, long>> schedules = {
+        {1, {"period", 1}}, {2, {"period", 5}}, {3, {"interval_ms", 200}}};
+
+    for (auto const& schedule : schedules) {
+        auto module = new tv::ModuleWrapper(create_idle, destroy_idle,
+                                            schedule.first, envir, "");
+        (void)module->initialize();
+        (void)module->set_parameter(schedule.second.first,
+                                    schedule.second.second);
+        (void)module->enable();
+        (void)modules.insert(schedule.first, module,
+                             [](tv::ModuleWrapper&) {});
+    }
+
+    tv::Scheduler scheduler;
+    tv::OverloadController overload;
+    std::map<int16_t, long> executions;
+    for (auto frame = 0; frame < 25; ++frame) {
+        time.sleep_for(std::chrono::milliseconds(40));
+        scheduler.schedule(modules, time.now(), overload);
+
+        modules.exec_all([&executions](int16_t id, tv::ModuleWrapper& module) {
+            if (module.scheduled()) {
+                executions[id]++;
+            }
+        });
+    }
+    expect("executions with period 1", 25, executions[1]);
+    expect("executions with period 5", 5, executions[2]);
+    expect("executions with interval_ms 200", 5, executions[3]);
+
+    // A wait times out as soon as the time is advanced past its deadline.
+    tv::VirtualTime manual(false);
+    tv::TimeSource::install(&manual);
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    auto timed_out = false;
+    // before the thread starts, which may happen after the first advances
+    auto const deadline = manual.now() + std::chrono::milliseconds(100);
+    std::thread waiting([&](void) {
+        std::unique_lock<std::mutex> lock(mutex);
+        timed_out = not manual.wait_until(lock, condition, deadline,
+                                          [](void) { return false; });
+    });
+
+    for (auto i = 0; i < 10; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        manual.advance(std::chrono::milliseconds(20));
+    }
+    waiting.join();
+    expect("wait timed out", 1, timed_out);
+
+    tv::TimeSource::install(nullptr);
+    return 0;
+}